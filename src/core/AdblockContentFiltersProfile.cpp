@@ -21,30 +21,34 @@
 
 #include "AdblockContentFiltersProfile.h"
 #include "Console.h"
-#include "Job.h"
 #include "SessionsManager.h"
 
 #include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QBuffer>
 #include <QtCore/QCoreApplication>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
 #include <QtCore/QDir>
+#include <QtCore/QFileInfo>
 #include <QtCore/QSaveFile>
+#include <QtCore/QSet>
 #include <QtCore/QTextStream>
 
+#include <algorithm>
+
 namespace Otter
 {
 
 QVector<QChar> AdblockContentFiltersProfile::m_separators({QLatin1Char('_'), QLatin1Char('-'), QLatin1Char('.'), QLatin1Char('%')});
+QVector<QChar> AdblockContentFiltersProfile::m_domainSeparators({QLatin1Char(':'), QLatin1Char('?'), QLatin1Char('&'), QLatin1Char('/'), QLatin1Char('=')});
 QHash<QString, AdblockContentFiltersProfile::RuleOption> AdblockContentFiltersProfile::m_options({{QLatin1String("third-party"), ThirdPartyOption}, {QLatin1String("stylesheet"), StyleSheetOption}, {QLatin1String("image"), ImageOption}, {QLatin1String("script"), ScriptOption}, {QLatin1String("object"), ObjectOption}, {QLatin1String("object-subrequest"), ObjectSubRequestOption}, {QLatin1String("object_subrequest"), ObjectSubRequestOption}, {QLatin1String("subdocument"), SubDocumentOption}, {QLatin1String("xmlhttprequest"), XmlHttpRequestOption}, {QLatin1String("websocket"), WebSocketOption}, {QLatin1String("popup"), PopupOption}, {QLatin1String("elemhide"), ElementHideOption}, {QLatin1String("generichide"), GenericHideOption}});
+std::shared_ptr<const AdblockContentFiltersProfile::CombinedRulesCache> AdblockContentFiltersProfile::m_combinedRules(std::make_shared<CombinedRulesCache>());
+std::atomic<quint64> AdblockContentFiltersProfile::m_combinedRulesGeneration(0);
+QMutex AdblockContentFiltersProfile::m_combinedRulesMutex;
 QHash<NetworkManager::ResourceType, AdblockContentFiltersProfile::RuleOption> AdblockContentFiltersProfile::m_resourceTypes({{NetworkManager::ImageType, ImageOption}, {NetworkManager::ScriptType, ScriptOption}, {NetworkManager::StyleSheetType, StyleSheetOption}, {NetworkManager::ObjectType, ObjectOption}, {NetworkManager::XmlHttpRequestType, XmlHttpRequestOption}, {NetworkManager::SubFrameType, SubDocumentOption},{NetworkManager::PopupType, PopupOption}, {NetworkManager::ObjectSubrequestType, ObjectSubRequestOption}, {NetworkManager::WebSocketType, WebSocketOption}});
 
-AdblockContentFiltersProfile::AdblockContentFiltersProfile(const ContentFiltersProfile::ProfileSummary &profileSummary, const QStringList &languages, ContentFiltersProfile::ProfileFlags flags, QObject *parent) : ContentFiltersProfile(parent),
-	m_root(nullptr),
-	m_dataFetchJob(nullptr),
-	m_profileSummary(profileSummary),
-	m_error(NoError),
-	m_flags(flags),
-	m_wasLoaded(false)
+AdblockContentFiltersProfile::AdblockContentFiltersProfile(const ContentFiltersProfile::ProfileSummary &profileSummary, const QStringList &languages, ContentFiltersProfile::ProfileFlags flags, QObject *parent) : ContentFiltersProfile(profileSummary, flags, parent)
 {
 	if (languages.isEmpty())
 	{
@@ -63,23 +67,9 @@ AdblockContentFiltersProfile::AdblockContentFiltersProfile(const ContentFiltersP
 	loadHeader();
 }
 
-void AdblockContentFiltersProfile::clear()
+AdblockContentFiltersProfile::~AdblockContentFiltersProfile()
 {
-	if (!m_wasLoaded)
-	{
-		return;
-	}
-
-	if (m_root)
-	{
-		QtConcurrent::run(this, &AdblockContentFiltersProfile::deleteNode, m_root);
-	}
-
-	m_cosmeticFiltersRules.clear();
-	m_cosmeticFiltersDomainExceptions.clear();
-	m_cosmeticFiltersDomainRules.clear();
-
-	m_wasLoaded = false;
+	cancelLoading();
 }
 
 void AdblockContentFiltersProfile::loadHeader()
@@ -111,29 +101,31 @@ void AdblockContentFiltersProfile::loadHeader()
 		return;
 	}
 
-	if (!m_flags.testFlag(HasCustomTitleFlag) && !information.title.isEmpty())
-	{
-		m_profileSummary.title = information.title;
-	}
+	setDefaultTitle(information.title);
 
-	if (!m_dataFetchJob && m_profileSummary.updateInterval > 0 && (!m_profileSummary.lastUpdate.isValid() || m_profileSummary.lastUpdate.daysTo(QDateTime::currentDateTimeUtc()) > m_profileSummary.updateInterval))
+	if (needsUpdate())
 	{
 		update();
 	}
 }
 
-void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
+void AdblockContentFiltersProfile::parseRuleLine(const QString &rule, RulesSnapshot &snapshot) const
 {
 	if (rule.isEmpty() || rule.startsWith(QLatin1Char('!')))
 	{
 		return;
 	}
 
+	if (rule.contains(QLatin1String("##")) || rule.contains(QLatin1String("#@#")))
+	{
+		snapshot.cosmeticFiltersLines.append(qHash(rule));
+	}
+
 	if (rule.startsWith(QLatin1String("##")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode == ContentFiltersManager::AllFilters)
+		if (snapshot.cosmeticFiltersMode == ContentFiltersManager::AllFilters)
 		{
-			m_cosmeticFiltersRules.append(rule.mid(2));
+			snapshot.cosmeticFiltersRules.append(rule.mid(2));
 		}
 
 		return;
@@ -141,9 +133,9 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 	if (rule.contains(QLatin1String("##")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
+		if (snapshot.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
 		{
-			parseStyleSheetRule(rule.split(QLatin1String("##")), m_cosmeticFiltersDomainRules);
+			parseStyleSheetRule(rule.split(QLatin1String("##")), snapshot.cosmeticFiltersDomainRules);
 		}
 
 		return;
@@ -151,9 +143,9 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 	if (rule.contains(QLatin1String("#@#")))
 	{
-		if (m_profileSummary.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
+		if (snapshot.cosmeticFiltersMode != ContentFiltersManager::NoFilters)
 		{
-			parseStyleSheetRule(rule.split(QLatin1String("#@#")), m_cosmeticFiltersDomainExceptions);
+			parseStyleSheetRule(rule.split(QLatin1String("#@#")), snapshot.cosmeticFiltersDomainExceptions);
 		}
 
 		return;
@@ -162,6 +154,7 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 	const int optionsSeparator(rule.indexOf(QLatin1Char('$')));
 	const QStringList options((optionsSeparator >= 0) ? rule.mid(optionsSeparator + 1).split(QLatin1Char(','), QString::SkipEmptyParts) : QStringList());
 	QString line(rule);
+	int lineOffset(0);
 
 	if (optionsSeparator >= 0)
 	{
@@ -176,43 +169,53 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 	if (line.startsWith(QLatin1Char('*')))
 	{
 		line = line.mid(1);
+
+		++lineOffset;
 	}
 
-	if (!m_profileSummary.areWildcardsEnabled && line.contains(QLatin1Char('*')))
+	if (!snapshot.areWildcardsEnabled && line.contains(QLatin1Char('*')))
 	{
 		return;
 	}
 
-	Node::Rule *definition(new Node::Rule());
-	definition->rule = rule;
-	definition->isException = line.startsWith(QLatin1String("@@"));
+	Rule definition;
+	definition.isException = line.startsWith(QLatin1String("@@"));
 
-	if (definition->isException)
+	if (definition.isException)
 	{
 		line = line.mid(2);
+
+		lineOffset += 2;
 	}
 
-	definition->needsDomainCheck = line.startsWith(QLatin1String("||"));
+	definition.needsDomainCheck = line.startsWith(QLatin1String("||"));
 
-	if (definition->needsDomainCheck)
+	if (definition.needsDomainCheck)
 	{
 		line = line.mid(2);
+
+		lineOffset += 2;
 	}
 
 	if (line.startsWith(QLatin1Char('|')))
 	{
-		definition->ruleMatch = StartMatch;
+		definition.ruleMatch = StartMatch;
 
 		line = line.mid(1);
+
+		++lineOffset;
 	}
 
 	if (line.endsWith(QLatin1Char('|')))
 	{
-		definition->ruleMatch = ((definition->ruleMatch == StartMatch) ? ExactMatch : EndMatch);
+		definition.ruleMatch = ((definition.ruleMatch == StartMatch) ? ExactMatch : EndMatch);
 
 		line = line.left(line.length() - 1);
 	}
 
+	QVector<quint32> blockedDomains;
+	QVector<quint32> allowedDomains;
+
 	for (int i = 0; i < options.count(); ++i)
 	{
 		const bool optionException(options.at(i).startsWith(QLatin1Char('~')));
@@ -222,18 +225,18 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 		{
 			const RuleOption option(m_options.value(optionName));
 
-			if ((!definition->isException || optionException) && (option == ElementHideOption || option == GenericHideOption))
+			if ((!definition.isException || optionException) && (option == ElementHideOption || option == GenericHideOption))
 			{
 				continue;
 			}
 
 			if (!optionException)
 			{
-				definition->ruleOptions |= option;
+				definition.ruleOptions |= option;
 			}
 			else if (option != WebSocketOption && option != PopupOption)
 			{
-				definition->ruleExceptions |= option;
+				definition.ruleExceptions |= option;
 			}
 		}
 		else if (optionName.startsWith(QLatin1String("domain")))
@@ -242,14 +245,23 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 
 			for (int j = 0; j < parsedDomains.count(); ++j)
 			{
-				if (parsedDomains.at(j).startsWith(QLatin1Char('~')))
-				{
-					definition->allowedDomains.append(parsedDomains.at(j).mid(1));
+				const bool isAllowed(parsedDomains.at(j).startsWith(QLatin1Char('~')));
+				const QString domain(isAllowed ? parsedDomains.at(j).mid(1) : parsedDomains.at(j));
+				QHash<QString, quint32>::const_iterator iterator(snapshot.domains.constFind(domain));
 
-					continue;
+				if (iterator == snapshot.domains.constEnd())
+				{
+					iterator = snapshot.domains.insert(domain, static_cast<quint32>(snapshot.domains.count()));
 				}
 
-				definition->blockedDomains.append(parsedDomains.at(j));
+				if (isAllowed)
+				{
+					allowedDomains.append(iterator.value());
+				}
+				else
+				{
+					blockedDomains.append(iterator.value());
+				}
 			}
 		}
 		else
@@ -258,183 +270,319 @@ void AdblockContentFiltersProfile::parseRuleLine(const QString &rule)
 		}
 	}
 
-	Node *node(m_root);
+	std::sort(blockedDomains.begin(), blockedDomains.end());
+	std::sort(allowedDomains.begin(), allowedDomains.end());
+
+	definition.ruleOffset = snapshot.text.length();
+	definition.ruleLength = rule.length();
+	definition.patternOffset = (definition.ruleOffset + lineOffset);
+	definition.patternLength = line.length();
+	definition.domainsOffset = snapshot.ruleDomains.count();
+	definition.blockedDomainsAmount = static_cast<quint16>(blockedDomains.count());
+	definition.allowedDomainsAmount = static_cast<quint16>(allowedDomains.count());
+	definition.isWildcard = line.contains(QLatin1Char('*'));
+
+	snapshot.text.append(rule);
+	snapshot.ruleDomains.append(blockedDomains);
+	snapshot.ruleDomains.append(allowedDomains);
+	snapshot.rules.append(definition);
+}
+
+void AdblockContentFiltersProfile::parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list) const
+{
+	const QStringList domains(line.at(0).split(QLatin1Char(',')));
+
+	for (int i = 0; i < domains.count(); ++i)
+	{
+		list.insert(domains.at(i), line.at(1));
+	}
+}
+
+void AdblockContentFiltersProfile::createCosmeticFiltersIndex(RulesSnapshot &snapshot) const
+{
+	snapshot.cosmeticFiltersGenericRules.clear();
+	snapshot.cosmeticFiltersIdentifierRules.clear();
+	snapshot.cosmeticFiltersClassRules.clear();
+	snapshot.cosmeticFiltersIdentifierRules.reserve(snapshot.cosmeticFiltersRules.count());
+	snapshot.cosmeticFiltersClassRules.reserve(snapshot.cosmeticFiltersRules.count());
 
-	for (int i = 0; i < line.length(); ++i)
+	for (int i = 0; i < snapshot.cosmeticFiltersRules.count(); ++i)
 	{
-		const QChar value(line.at(i));
-		bool childrenExists(false);
+		const QString &rule(snapshot.cosmeticFiltersRules.at(i));
+		const QChar prefix(rule.value(0));
 
-		for (int j = 0; j < node->children.count(); ++j)
+		if ((prefix != QLatin1Char('#') && prefix != QLatin1Char('.')) || rule.contains(QLatin1Char(',')))
 		{
-			Node *nextNode(node->children.at(j));
+			snapshot.cosmeticFiltersGenericRules.append(i);
 
-			if (nextNode->value == value)
-			{
-				node = nextNode;
+			continue;
+		}
 
-				childrenExists = true;
+		int length(1);
 
+		while (length < rule.length())
+		{
+			const QChar character(rule.at(length));
+
+			if (!character.isLetterOrNumber() && character != QLatin1Char('-') && character != QLatin1Char('_') && character.unicode() < 128)
+			{
 				break;
 			}
+
+			++length;
 		}
 
-		if (!childrenExists)
+		if (length == 1 || (length < rule.length() && rule.at(length) == QLatin1Char('\\')))
 		{
-			Node *newNode(new Node());
-			newNode->value = value;
+			snapshot.cosmeticFiltersGenericRules.append(i);
 
-			if (value == QLatin1Char('^'))
-			{
-				node->children.insert(0, newNode);
-			}
-			else
-			{
-				node->children.append(newNode);
-			}
+			continue;
+		}
 
-			node = newNode;
+		if (prefix == QLatin1Char('#'))
+		{
+			snapshot.cosmeticFiltersIdentifierRules.insert(rule.mid(1, (length - 1)), i);
+		}
+		else
+		{
+			snapshot.cosmeticFiltersClassRules.insert(rule.mid(1, (length - 1)), i);
 		}
 	}
 
-	node->rules.append(definition);
+	snapshot.cosmeticFiltersGenericRules.squeeze();
 }
 
-void AdblockContentFiltersProfile::parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list)
+void AdblockContentFiltersProfile::createTokensIndex(RulesSnapshot &snapshot, const QVector<quint64> &knownTokens) const
 {
-	const QStringList domains(line.at(0).split(QLatin1Char(',')));
+	const bool hasKnownTokens(knownTokens.count() == snapshot.rules.count());
+	QVector<quint64> rulesTokens(snapshot.rules.count(), 0);
+	QVector<bool> areRulesTokenized(snapshot.rules.count(), false);
+	QHash<quint64, int> frequencies;
+	QHash<quint64, int> amounts;
 
-	for (int i = 0; i < domains.count(); ++i)
+	if (hasKnownTokens)
 	{
-		list.insert(domains.at(i), line.at(1));
-	}
-}
+		for (int i = 0; i < knownTokens.count(); ++i)
+		{
+			if (knownTokens.at(i) != 0 && knownTokens.at(i) != m_untokenizedToken)
+			{
+				rulesTokens[i] = knownTokens.at(i);
+				areRulesTokenized[i] = true;
 
-void AdblockContentFiltersProfile::deleteNode(Node *node) const
-{
-	for (int i = 0; i < node->children.count(); ++i)
-	{
-		deleteNode(node->children.at(i));
+				++amounts[knownTokens.at(i)];
+			}
+		}
 	}
-
-	for (int i = 0; i < node->rules.count(); ++i)
+	else
 	{
-		delete node->rules.at(i);
-	}
+		for (int i = 0; i < snapshot.rules.count(); ++i)
+		{
+			const QVector<quint64> tokens(getRuleTokens(snapshot, snapshot.rules.at(i), false));
 
-	delete node;
-}
+			for (int j = 0; j < tokens.count(); ++j)
+			{
+				++frequencies[tokens.at(j)];
+			}
+		}
 
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkUrlSubstring(const Node *node, const QString &subString, QString currentRule, const Request &request) const
-{
-	ContentFiltersManager::CheckResult result;
-	ContentFiltersManager::CheckResult currentResult;
+		amounts.reserve(frequencies.count());
+	}
 
-	for (int i = 0; i < subString.length(); ++i)
+	for (int i = 0; i < snapshot.rules.count(); ++i)
 	{
-		const QChar treeChar(subString.at(i));
-		bool childrenExists(false);
+		if (hasKnownTokens && knownTokens.at(i) != 0)
+		{
+			if (knownTokens.at(i) == m_untokenizedToken)
+			{
+				snapshot.untokenizedRules.append(i);
+			}
 
-		currentResult = evaluateNodeRules(node, currentRule, request);
+			continue;
+		}
 
-		if (currentResult.isBlocked)
+		Rule &rule(snapshot.rules[i]);
+		QVector<quint64> tokens(getRuleTokens(snapshot, rule, true));
+		const bool isLeading(!tokens.isEmpty());
+
+		if (!isLeading)
 		{
-			result = currentResult;
+			tokens = getRuleTokens(snapshot, rule, false);
 		}
-		else if (currentResult.isException)
+
+		if (tokens.isEmpty())
 		{
-			return currentResult;
+			snapshot.untokenizedRules.append(i);
+
+			continue;
 		}
 
-		for (int j = 0; j < node->children.count(); ++j)
+		const QHash<quint64, int> &tokensFrequencies(hasKnownTokens ? amounts : frequencies);
+		quint64 rarestToken(tokens.first());
+		int lowestFrequency(tokensFrequencies.value(rarestToken));
+
+		for (int j = 1; j < tokens.count(); ++j)
 		{
-			const Node *nextNode(node->children.at(j));
+			const int frequency(tokensFrequencies.value(tokens.at(j)));
 
-			if (nextNode->value == QLatin1Char('*'))
+			if (frequency < lowestFrequency)
 			{
-				const QString wildcardSubString(subString.mid(i));
-
-				for (int k = 0; k < wildcardSubString.length(); ++k)
-				{
-					currentResult = checkUrlSubstring(nextNode, wildcardSubString.right(wildcardSubString.length() - k), (currentRule + wildcardSubString.left(k)), request);
-
-					if (currentResult.isBlocked)
-					{
-						result = currentResult;
-					}
-					else if (currentResult.isException)
-					{
-						return currentResult;
-					}
-				}
+				rarestToken = tokens.at(j);
+				lowestFrequency = frequency;
 			}
+		}
 
-			if (nextNode->value == QLatin1Char('^') && !treeChar.isDigit() && !treeChar.isLetter() && !m_separators.contains(treeChar))
+		if (isLeading)
+		{
+			const QChar *pattern(snapshot.text.constData() + rule.patternOffset);
+			quint64 token(0);
+			int length(0);
+			int offset(0);
+
+			for (int j = 0; j < rule.patternLength; ++j)
 			{
-				currentResult = checkUrlSubstring(nextNode, subString.mid(i), currentRule, request);
+				const QChar character(pattern[j]);
 
-				if (currentResult.isBlocked)
+				if (character == QLatin1Char('*'))
 				{
-					result = currentResult;
+					break;
 				}
-				else if (currentResult.isException)
+
+				if (character == QLatin1Char('^'))
 				{
-					return currentResult;
+					length = 0;
+
+					continue;
 				}
-			}
 
-			if (nextNode->value == treeChar)
-			{
-				node = nextNode;
+				token = ((token << 16) | character.unicode());
 
-				childrenExists = true;
+				++length;
+				++offset;
 
-				break;
+				if (length >= m_tokenLength && token == rarestToken)
+				{
+					rule.tokenOffset = (offset - m_tokenLength);
+
+					break;
+				}
 			}
 		}
 
-		if (!childrenExists)
+		rulesTokens[i] = rarestToken;
+		areRulesTokenized[i] = true;
+
+		++amounts[rarestToken];
+	}
+
+	snapshot.tokens.reserve(amounts.count());
+	snapshot.tokenRules.resize(snapshot.rules.count() - snapshot.untokenizedRules.count());
+
+	int offset(0);
+	QHash<quint64, int>::const_iterator iterator;
+
+	for (iterator = amounts.constBegin(); iterator != amounts.constEnd(); ++iterator)
+	{
+		TokenRange range;
+		range.offset = offset;
+
+		snapshot.tokens.insert(iterator.key(), range);
+
+		offset += iterator.value();
+	}
+
+	for (int i = 0; i < snapshot.rules.count(); ++i)
+	{
+		if (areRulesTokenized.at(i))
 		{
-			return result;
+			TokenRange &range(snapshot.tokens[rulesTokens.at(i)]);
+
+			snapshot.tokenRules[range.offset + range.amount] = i;
+
+			++range.amount;
 		}
+	}
+
+	snapshot.untokenizedRules.squeeze();
+}
 
-		currentRule += treeChar;
+std::shared_ptr<const AdblockContentFiltersProfile::RulesSnapshot> AdblockContentFiltersProfile::getSnapshot() const
+{
+	return std::atomic_load(&m_snapshot);
+}
+
+std::shared_ptr<const AdblockContentFiltersProfile::CombinedRules> AdblockContentFiltersProfile::getCombinedRules(const QVector<AdblockContentFiltersProfile*> &profiles)
+{
+	const quint64 key(getCombinedRulesKey(profiles));
+	std::shared_ptr<const CombinedRules> cachedCombinedRules(getCachedCombinedRules(*std::atomic_load(&m_combinedRules), key, profiles));
+
+	if (cachedCombinedRules)
+	{
+		return cachedCombinedRules;
 	}
 
-	currentResult = evaluateNodeRules(node, currentRule, request);
+	QMutexLocker locker(&m_combinedRulesMutex);
+	const std::shared_ptr<const CombinedRulesCache> cache(std::atomic_load(&m_combinedRules));
 
-	if (currentResult.isBlocked)
+	cachedCombinedRules = getCachedCombinedRules(*cache, key, profiles);
+
+	if (cachedCombinedRules)
 	{
-		result = currentResult;
+		return cachedCombinedRules;
 	}
-	else if (currentResult.isException)
+
+	std::shared_ptr<CombinedRules> combinedRules(std::make_shared<CombinedRules>());
+	combinedRules->profiles.reserve(profiles.count());
+	combinedRules->snapshots.reserve(profiles.count());
+	combinedRules->generation = m_combinedRulesGeneration.load(std::memory_order_acquire);
+
+	for (int i = 0; i < profiles.count(); ++i)
 	{
-		return currentResult;
+		combinedRules->profiles.append(profiles.at(i));
+		combinedRules->snapshots.append(profiles.at(i)->getSnapshot());
 	}
 
-	for (int i = 0; i < node->children.count(); ++i)
+	std::shared_ptr<CombinedRulesCache> updatedCache(std::make_shared<CombinedRulesCache>(*cache));
+	updatedCache->rules[key] = combinedRules;
+
+	std::atomic_store(&m_combinedRules, std::shared_ptr<const CombinedRulesCache>(updatedCache));
+
+	locker.unlock();
+
+	if (profiles.count() > 1)
 	{
-		if (node->children.at(i)->value == QLatin1Char('^'))
-		{
-			currentResult = evaluateNodeRules(node, currentRule, request);
+		QtConcurrent::run(&AdblockContentFiltersProfile::createCombinedRules, key);
+	}
 
-			if (currentResult.isBlocked)
-			{
-				result = currentResult;
-			}
-			else if (currentResult.isException)
-			{
-				return currentResult;
-			}
-		}
+	return combinedRules;
+}
+
+std::shared_ptr<const AdblockContentFiltersProfile::CombinedRules> AdblockContentFiltersProfile::getCachedCombinedRules(const CombinedRulesCache &cache, quint64 key, const QVector<AdblockContentFiltersProfile*> &profiles)
+{
+	const std::shared_ptr<const CombinedRules> combinedRules(cache.rules.value(key));
+
+	if (!combinedRules || combinedRules->generation != m_combinedRulesGeneration.load(std::memory_order_acquire) || combinedRules->profiles.count() != profiles.count() || !std::equal(profiles.constBegin(), profiles.constEnd(), combinedRules->profiles.constBegin()))
+	{
+		return nullptr;
 	}
 
-	return result;
+	return combinedRules;
+}
+
+quint64 AdblockContentFiltersProfile::getCombinedRulesKey(const QVector<AdblockContentFiltersProfile*> &profiles)
+{
+	quint64 key(Q_UINT64_C(0xCBF29CE484222325));
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		key = ((key ^ static_cast<quint64>(reinterpret_cast<quintptr>(profiles.at(i)))) * Q_UINT64_C(0x100000001B3));
+	}
+
+	return key;
 }
 
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(const Node::Rule *rule, const QString &currentRule, const Request &request) const
+ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(const RulesSnapshot &snapshot, const Rule &rule, const QStringRef &currentRule, const Request &request) const
 {
-	switch (rule->ruleMatch)
+	switch (rule.ruleMatch)
 	{
 		case StartMatch:
 			if (!request.requestUrl.startsWith(currentRule))
@@ -466,20 +614,41 @@ ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(
 			break;
 	}
 
-	const QStringList requestSubdomainList(ContentFiltersManager::createSubdomainList(request.requestHost));
-
-	if (rule->needsDomainCheck && !requestSubdomainList.contains(currentRule.left(currentRule.indexOf(m_domainExpression))))
+	if (rule.needsDomainCheck)
 	{
-		return {};
+		int domainLength(0);
+
+		while (domainLength < currentRule.length() && !m_domainSeparators.contains(currentRule.at(domainLength)))
+		{
+			++domainLength;
+		}
+
+		const QStringRef domain(currentRule.left(domainLength));
+		bool hasDomain(false);
+
+		for (int i = 0; i < request.requestSubdomains.count(); ++i)
+		{
+			if (request.requestSubdomains.at(i) == domain)
+			{
+				hasDomain = true;
+
+				break;
+			}
+		}
+
+		if (!hasDomain)
+		{
+			return {};
+		}
 	}
 
-	const bool hasBlockedDomains(!rule->blockedDomains.isEmpty());
-	const bool hasAllowedDomains(!rule->allowedDomains.isEmpty());
+	const bool hasBlockedDomains(rule.blockedDomainsAmount > 0);
+	const bool hasAllowedDomains(rule.allowedDomainsAmount > 0);
 	bool isBlocked(true);
 
 	if (hasBlockedDomains)
 	{
-		isBlocked = resolveDomainExceptions(request.baseHost, rule->blockedDomains);
+		isBlocked = resolveDomainExceptions(snapshot, request.baseSubdomains, rule.domainsOffset, rule.blockedDomainsAmount);
 
 		if (!isBlocked)
 		{
@@ -487,21 +656,21 @@ ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(
 		}
 	}
 
-	isBlocked = (hasAllowedDomains ? !resolveDomainExceptions(request.baseHost, rule->allowedDomains) : isBlocked);
+	isBlocked = (hasAllowedDomains ? !resolveDomainExceptions(snapshot, request.baseSubdomains, (rule.domainsOffset + rule.blockedDomainsAmount), rule.allowedDomainsAmount) : isBlocked);
 
-	if (rule->ruleOptions.testFlag(ThirdPartyOption) || rule->ruleExceptions.testFlag(ThirdPartyOption))
+	if (rule.ruleOptions.testFlag(ThirdPartyOption) || rule.ruleExceptions.testFlag(ThirdPartyOption))
 	{
-		if (request.baseHost.isEmpty() || requestSubdomainList.contains(request.baseHost))
+		if (request.baseHost.isEmpty() || request.requestSubdomains.contains(request.baseHost))
 		{
-			isBlocked = rule->ruleExceptions.testFlag(ThirdPartyOption);
+			isBlocked = rule.ruleExceptions.testFlag(ThirdPartyOption);
 		}
 		else if (!hasBlockedDomains && !hasAllowedDomains)
 		{
-			isBlocked = rule->ruleOptions.testFlag(ThirdPartyOption);
+			isBlocked = rule.ruleOptions.testFlag(ThirdPartyOption);
 		}
 	}
 
-	if (rule->ruleOptions != NoOption || rule->ruleExceptions != NoOption)
+	if (rule.ruleOptions != NoOption || rule.ruleExceptions != NoOption)
 	{
 		QHash<NetworkManager::ResourceType, RuleOption>::const_iterator iterator;
 
@@ -509,15 +678,15 @@ ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(
 		{
 			const bool supportsException(iterator.value() != WebSocketOption && iterator.value() != PopupOption);
 
-			if (rule->ruleOptions.testFlag(iterator.value()) || (supportsException && rule->ruleExceptions.testFlag(iterator.value())))
+			if (rule.ruleOptions.testFlag(iterator.value()) || (supportsException && rule.ruleExceptions.testFlag(iterator.value())))
 			{
 				if (request.resourceType == iterator.key())
 				{
-					isBlocked = (isBlocked ? rule->ruleOptions.testFlag(iterator.value()) : isBlocked);
+					isBlocked = (isBlocked ? rule.ruleOptions.testFlag(iterator.value()) : isBlocked);
 				}
 				else if (supportsException)
 				{
-					isBlocked = (isBlocked ? rule->ruleExceptions.testFlag(iterator.value()) : isBlocked);
+					isBlocked = (isBlocked ? rule.ruleExceptions.testFlag(iterator.value()) : isBlocked);
 				}
 				else
 				{
@@ -534,18 +703,18 @@ ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(
 	if (isBlocked)
 	{
 		ContentFiltersManager::CheckResult result;
-		result.rule = rule->rule;
+		result.rule = snapshot.text.mid(rule.ruleOffset, rule.ruleLength);
 
-		if (rule->isException)
+		if (rule.isException)
 		{
 			result.isBlocked = false;
 			result.isException = true;
 
-			if (rule->ruleOptions.testFlag(ElementHideOption))
+			if (rule.ruleOptions.testFlag(ElementHideOption))
 			{
 				result.comesticFiltersMode = ContentFiltersManager::NoFilters;
 			}
-			else if (rule->ruleOptions.testFlag(GenericHideOption))
+			else if (rule.ruleOptions.testFlag(GenericHideOption))
 			{
 				result.comesticFiltersMode = ContentFiltersManager::DomainOnlyFilters;
 			}
@@ -561,243 +730,777 @@ ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkRuleMatch(
 	return {};
 }
 
-void AdblockContentFiltersProfile::raiseError(const QString &message, ProfileError error)
+void AdblockContentFiltersProfile::handleRulesUpdated(int addedRules, int removedRules)
 {
-	m_error = error;
-
-	Console::addMessage(message, Console::OtherCategory, Console::ErrorLevel, getPath());
-
-	emit profileModified();
+	Console::addMessage(QCoreApplication::translate("main", "Content blocking profile %1 updated: %2 rules added, %3 rules removed").arg(getTitle()).arg(addedRules).arg(removedRules), Console::OtherCategory, Console::LogLevel, getPath());
 }
 
-void AdblockContentFiltersProfile::handleJobFinished(bool isSuccess)
+void AdblockContentFiltersProfile::saveCache(const RulesSnapshot &snapshot, const QString &path, const CacheKey &key) const
 {
-	if (!m_dataFetchJob)
+	if (SessionsManager::isReadOnly())
 	{
 		return;
 	}
 
-	QIODevice *device(m_dataFetchJob->getData());
+	QSaveFile file(path);
 
-	m_dataFetchJob->deleteLater();
-	m_dataFetchJob = nullptr;
-
-	if (!isSuccess)
+	if (!file.open(QIODevice::WriteOnly))
 	{
-		raiseError(QCoreApplication::translate("main", "Failed to update content blocking profile: %1").arg(device ? device->errorString() : tr("Download failure")), DownloadError);
-
 		return;
 	}
 
-	QBuffer buffer;
-	buffer.setData(device->readAll());
-	buffer.open(QIODevice::ReadOnly | QIODevice::Text);
-
-	const HeaderInformation information(loadHeader(&buffer));
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_6);
+	stream << m_cacheMagic << m_cacheVersion << m_ruleLayoutVersion << static_cast<quint32>(sizeof(Rule)) << key.size << key.lastModified << key.checksum << static_cast<quint8>(snapshot.cosmeticFiltersMode) << snapshot.areWildcardsEnabled << static_cast<quint32>(snapshot.rules.count());
+	stream.writeRawData(reinterpret_cast<const char*>(snapshot.rules.constData()), static_cast<int>(snapshot.rules.count() * sizeof(Rule)));
 
-	buffer.reset();
+	QVector<QString> domains(snapshot.domains.count());
+	QHash<QString, quint32>::const_iterator domainsIterator;
 
-	if (information.error != NoError)
+	for (domainsIterator = snapshot.domains.constBegin(); domainsIterator != snapshot.domains.constEnd(); ++domainsIterator)
 	{
-		raiseError(information.errorString, information.error);
-
-		return;
+		domains[static_cast<int>(domainsIterator.value())] = domainsIterator.key();
 	}
 
-	QDir().mkpath(SessionsManager::getWritableDataPath(QLatin1String("contentBlocking")));
+	QVector<quint64> tokens;
+	QVector<qint32> ranges;
+	tokens.reserve(snapshot.tokens.count());
+	ranges.reserve(snapshot.tokens.count() * 2);
 
-	QSaveFile file(getPath());
+	QHash<quint64, TokenRange>::const_iterator tokensIterator;
 
-	if (!file.open(QIODevice::WriteOnly))
+	for (tokensIterator = snapshot.tokens.constBegin(); tokensIterator != snapshot.tokens.constEnd(); ++tokensIterator)
 	{
-		raiseError(QCoreApplication::translate("main", "Failed to update content blocking profile: %1").arg(file.errorString()), DownloadError);
-
-		return;
+		tokens.append(tokensIterator.key());
+		ranges.append(tokensIterator.value().offset);
+		ranges.append(tokensIterator.value().amount);
 	}
 
-	file.write(buffer.data());
+	stream << snapshot.text << snapshot.untokenizedRules << snapshot.tokenRules << snapshot.ruleDomains << domains << tokens << ranges << snapshot.cosmeticFiltersRules << snapshot.cosmeticFiltersDomainRules << snapshot.cosmeticFiltersDomainExceptions << snapshot.cosmeticFiltersLines;
 
-	m_profileSummary.lastUpdate = QDateTime::currentDateTimeUtc();
+	file.commit();
+}
 
-	if (!file.commit())
-	{
-		Console::addMessage(QCoreApplication::translate("main", "Failed to update content blocking profile: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
-	}
+void AdblockContentFiltersProfile::createSnapshot(const QString &path, const QString &cachePath, const ContentFiltersProfile::ProfileSummary &profileSummary, quint64 generation, bool isUpdate)
+{
+	const QFileInfo fileInfo(path);
+	CacheKey cacheKey;
+	cacheKey.size = fileInfo.size();
+	cacheKey.lastModified = fileInfo.lastModified().toMSecsSinceEpoch();
 
-	clear();
-	loadHeader();
+	std::shared_ptr<RulesSnapshot> snapshot(std::make_shared<RulesSnapshot>());
+	snapshot->cosmeticFiltersMode = profileSummary.cosmeticFiltersMode;
+	snapshot->areWildcardsEnabled = profileSummary.areWildcardsEnabled;
+
+	bool isCached(loadCache(*snapshot, cachePath, cacheKey));
+	QByteArray data;
 
-	if (m_wasLoaded)
+	if (!isCached)
 	{
-		loadRules();
-	}
+		QFile file(path);
+		file.open(QIODevice::ReadOnly | QIODevice::Text);
 
-	emit profileModified();
-}
+		data = file.readAll();
 
-void AdblockContentFiltersProfile::setProfileSummary(const ContentFiltersProfile::ProfileSummary &profileSummary)
-{
-	const bool needsReload(profileSummary.cosmeticFiltersMode != m_profileSummary.cosmeticFiltersMode || profileSummary.areWildcardsEnabled != m_profileSummary.areWildcardsEnabled);
+		file.close();
 
-	if (profileSummary.title != m_profileSummary.title)
-	{
-		m_flags |= HasCustomTitleFlag;
-	}
-	else if (!needsReload && profileSummary.updateUrl == m_profileSummary.updateUrl && profileSummary.updateInterval == m_profileSummary.updateInterval && profileSummary.category == m_profileSummary.category)
-	{
-		return;
-	}
+		cacheKey.checksum = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
 
-	m_profileSummary = profileSummary;
+		snapshot = std::make_shared<RulesSnapshot>();
+		snapshot->cosmeticFiltersMode = profileSummary.cosmeticFiltersMode;
+		snapshot->areWildcardsEnabled = profileSummary.areWildcardsEnabled;
 
-	if (needsReload)
-	{
-		clear();
+		isCached = loadCache(*snapshot, cachePath, cacheKey);
+
+		if (isCached)
+		{
+			saveCache(*snapshot, cachePath, cacheKey);
+		}
 	}
 
-	emit profileModified();
-}
+	if (!isCached)
+	{
+		snapshot = std::make_shared<RulesSnapshot>();
+		snapshot->cosmeticFiltersMode = profileSummary.cosmeticFiltersMode;
+		snapshot->areWildcardsEnabled = profileSummary.areWildcardsEnabled;
 
-QString AdblockContentFiltersProfile::getName() const
-{
-	return m_profileSummary.name;
-}
+		const std::shared_ptr<const RulesSnapshot> previousSnapshot(isUpdate ? getSnapshot() : nullptr);
+		QHash<QString, int> previousRules;
+		QVector<quint64> previousTokens;
+		QVector<quint64> knownTokens;
+		QVector<bool> areRulesCopied;
+		const bool isIncremental(previousSnapshot && previousSnapshot->cosmeticFiltersMode == snapshot->cosmeticFiltersMode && previousSnapshot->areWildcardsEnabled == snapshot->areWildcardsEnabled);
+		int addedRules(0);
 
-QString AdblockContentFiltersProfile::getTitle() const
-{
-	return (m_profileSummary.title.isEmpty() ? tr("(Unknown)") : m_profileSummary.title);
-}
+		if (isIncremental)
+		{
+			previousRules.reserve(previousSnapshot->rules.count());
+			previousTokens.fill(m_untokenizedToken, previousSnapshot->rules.count());
+			areRulesCopied.fill(false, previousSnapshot->rules.count());
 
-QString AdblockContentFiltersProfile::getPath() const
-{
-	return SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.txt")).arg(m_profileSummary.name);
-}
+			for (int i = 0; i < previousSnapshot->rules.count(); ++i)
+			{
+				const Rule &rule(previousSnapshot->rules.at(i));
 
-QDateTime AdblockContentFiltersProfile::getLastUpdate() const
-{
-	return m_profileSummary.lastUpdate;
-}
+				previousRules.insert(previousSnapshot->text.mid(rule.ruleOffset, rule.ruleLength), i);
+			}
 
-QUrl AdblockContentFiltersProfile::getUpdateUrl() const
-{
-	return m_profileSummary.updateUrl;
-}
+			QHash<quint64, TokenRange>::const_iterator iterator;
 
-AdblockContentFiltersProfile::HeaderInformation AdblockContentFiltersProfile::loadHeader(QIODevice *rulesDevice)
-{
-	HeaderInformation information;
-	QTextStream stream(rulesDevice);
-	stream.setCodec("UTF-8");
+			for (iterator = previousSnapshot->tokens.constBegin(); iterator != previousSnapshot->tokens.constEnd(); ++iterator)
+			{
+				for (int i = 0; i < iterator.value().amount; ++i)
+				{
+					previousTokens[previousSnapshot->tokenRules.at(iterator.value().offset + i)] = iterator.key();
+				}
+			}
 
-	const QString header(stream.readLine());
+			snapshot->domains = previousSnapshot->domains;
 
-	if (!header.contains(QLatin1String("[Adblock"), Qt::CaseInsensitive))
-	{
-		information.errorString = QCoreApplication::translate("main", "Failed to update content blocking profile: invalid header");
-		information.error = ParseError;
+			knownTokens.reserve(previousSnapshot->rules.count());
+		}
 
-		return information;
-	}
+		QTextStream stream(data);
+		stream.setCodec("UTF-8");
+		stream.readLine(); // header
 
-	int lineNumber(1);
+		while (!stream.atEnd())
+		{
+			const QString line(stream.readLine());
+			const QHash<QString, int>::const_iterator iterator(previousRules.constFind(line));
 
-	while (!stream.atEnd())
-	{
-		const QString line(stream.readLine().trimmed());
+			if (iterator == previousRules.constEnd())
+			{
+				const int rulesAmount(snapshot->rules.count());
 
-		if (line.startsWith(QLatin1String("! Title: ")))
-		{
-			information.title = line.section(QLatin1Char(':'), 1).trimmed();
+				parseRuleLine(line, *snapshot);
 
-			continue;
+				if (!previousRules.isEmpty())
+				{
+					knownTokens.resize(snapshot->rules.count());
+				}
+
+				addedRules += (snapshot->rules.count() - rulesAmount);
+			}
+			else
+			{
+				copyRule(*previousSnapshot, previousSnapshot->rules.at(iterator.value()), *snapshot);
+
+				knownTokens.append(previousTokens.at(iterator.value()));
+
+				areRulesCopied[iterator.value()] = true;
+			}
 		}
 
-		if (lineNumber > 50)
+		std::sort(snapshot->cosmeticFiltersLines.begin(), snapshot->cosmeticFiltersLines.end());
+
+		if (isIncremental)
 		{
-			break;
+			const QVector<uint> &previousLines(previousSnapshot->cosmeticFiltersLines);
+			const QVector<uint> &lines(snapshot->cosmeticFiltersLines);
+			int removedRules(areRulesCopied.count(false));
+			int previousIndex(0);
+			int index(0);
+
+			while (previousIndex < previousLines.count() || index < lines.count())
+			{
+				if (index >= lines.count() || (previousIndex < previousLines.count() && previousLines.at(previousIndex) < lines.at(index)))
+				{
+					++removedRules;
+					++previousIndex;
+				}
+				else if (previousIndex >= previousLines.count() || lines.at(index) < previousLines.at(previousIndex))
+				{
+					++addedRules;
+					++index;
+				}
+				else
+				{
+					++previousIndex;
+					++index;
+				}
+			}
+
+			QMetaObject::invokeMethod(this, "handleRulesUpdated", Qt::QueuedConnection, Q_ARG(int, addedRules), Q_ARG(int, removedRules));
 		}
 
-		++lineNumber;
+		if (!previousRules.isEmpty())
+		{
+			compactDomains(*snapshot);
+		}
+
+		snapshot->text.squeeze();
+		snapshot->rules.squeeze();
+		snapshot->ruleDomains.squeeze();
+
+		createTokensIndex(*snapshot, knownTokens);
+		saveCache(*snapshot, cachePath, cacheKey);
 	}
 
-	return information;
+	createCosmeticFiltersIndex(*snapshot);
+
+	finishLoading(generation, [&]()
+	{
+		setSnapshot(snapshot);
+	});
 }
 
-ContentFiltersProfile::ProfileSummary AdblockContentFiltersProfile::getProfileSummary() const
+void AdblockContentFiltersProfile::copyRule(const RulesSnapshot &source, const Rule &rule, RulesSnapshot &target) const
 {
-	return m_profileSummary;
+	Rule definition(rule);
+	definition.ruleOffset = target.text.length();
+	definition.patternOffset = (definition.ruleOffset + (rule.patternOffset - rule.ruleOffset));
+	definition.domainsOffset = target.ruleDomains.count();
+
+	target.text.append(source.text.constData() + rule.ruleOffset, rule.ruleLength);
+	target.ruleDomains.append(source.ruleDomains.mid(rule.domainsOffset, (rule.blockedDomainsAmount + rule.allowedDomainsAmount)));
+	target.rules.append(definition);
 }
 
-ContentFiltersManager::CheckResult AdblockContentFiltersProfile::evaluateNodeRules(const Node *node, const QString &currentRule, const Request &request) const
+void AdblockContentFiltersProfile::compactDomains(RulesSnapshot &snapshot) const
 {
-	ContentFiltersManager::CheckResult result;
+	QVector<bool> areDomainsUsed(snapshot.domains.count(), false);
+	int usedDomainsAmount(0);
+
+	for (int i = 0; i < snapshot.ruleDomains.count(); ++i)
+	{
+		const int identifier(static_cast<int>(snapshot.ruleDomains.at(i)));
+
+		if (!areDomainsUsed.at(identifier))
+		{
+			areDomainsUsed[identifier] = true;
+
+			++usedDomainsAmount;
+		}
+	}
+
+	if ((usedDomainsAmount * 2) >= snapshot.domains.count())
+	{
+		return;
+	}
+
+	QVector<QString> names(snapshot.domains.count());
+	QHash<QString, quint32>::const_iterator iterator;
+
+	for (iterator = snapshot.domains.constBegin(); iterator != snapshot.domains.constEnd(); ++iterator)
+	{
+		names[static_cast<int>(iterator.value())] = iterator.key();
+	}
+
+	QVector<quint32> identifiers(names.count(), 0);
+	QHash<QString, quint32> domains;
+	domains.reserve(usedDomainsAmount);
+
+	for (int i = 0; i < names.count(); ++i)
+	{
+		if (areDomainsUsed.at(i))
+		{
+			identifiers[i] = static_cast<quint32>(domains.count());
+
+			domains.insert(names.at(i), identifiers.at(i));
+		}
+	}
+
+	for (int i = 0; i < snapshot.ruleDomains.count(); ++i)
+	{
+		snapshot.ruleDomains[i] = identifiers.at(static_cast<int>(snapshot.ruleDomains.at(i)));
+	}
+
+	snapshot.domains = domains;
+}
+
+void AdblockContentFiltersProfile::clearSnapshot()
+{
+	setSnapshot({});
+}
+
+void AdblockContentFiltersProfile::setSnapshot(const std::shared_ptr<const RulesSnapshot> &snapshot)
+{
+	std::shared_ptr<const RulesSnapshot> *previousSnapshot(new std::shared_ptr<const RulesSnapshot>(std::atomic_exchange(&m_snapshot, snapshot)));
+
+	updateCombinedRules(this);
 
-	for (int i = 0; i < node->rules.count(); ++i)
+	if (*previousSnapshot)
 	{
-		if (node->rules.at(i))
+		QtConcurrent::run([=]()
 		{
-			ContentFiltersManager::CheckResult currentResult(checkRuleMatch(node->rules.at(i), currentRule, request));
+			delete previousSnapshot;
+		});
+	}
+	else
+	{
+		delete previousSnapshot;
+	}
+}
+
+void AdblockContentFiltersProfile::createCombinedRules(quint64 key)
+{
+	const std::shared_ptr<const CombinedRules> previousCombinedRules(std::atomic_load(&m_combinedRules)->rules.value(key));
+
+	if (!previousCombinedRules || previousCombinedRules->isMerged)
+	{
+		return;
+	}
+
+	std::shared_ptr<CombinedRules> combinedRules(std::make_shared<CombinedRules>());
+	combinedRules->profiles = previousCombinedRules->profiles;
+	combinedRules->snapshots = previousCombinedRules->snapshots;
 
-			if (currentResult.isBlocked)
+	for (int i = 0; i < combinedRules->snapshots.count(); ++i)
+	{
+		const std::shared_ptr<const RulesSnapshot> snapshot(combinedRules->snapshots.at(i));
+
+		if (!snapshot)
+		{
+			continue;
+		}
+
+		QHash<quint64, TokenRange>::const_iterator iterator;
+
+		for (iterator = snapshot->tokens.constBegin(); iterator != snapshot->tokens.constEnd(); ++iterator)
+		{
+			QVector<RuleReference> &references(combinedRules->tokens[iterator.key()]);
+			const TokenRange &range(iterator.value());
+
+			for (int j = 0; j < range.amount; ++j)
 			{
-				result = currentResult;
+				RuleReference reference;
+				reference.profile = i;
+				reference.rule = snapshot->tokenRules.at(range.offset + j);
+
+				references.append(reference);
 			}
-			else if (currentResult.isException)
+		}
+
+		for (int j = 0; j < snapshot->untokenizedRules.count(); ++j)
+		{
+			RuleReference reference;
+			reference.profile = i;
+			reference.rule = snapshot->untokenizedRules.at(j);
+
+			combinedRules->untokenizedRules.append(reference);
+		}
+	}
+
+	combinedRules->isMerged = true;
+
+	QMutexLocker locker(&m_combinedRulesMutex);
+	const std::shared_ptr<const CombinedRulesCache> cache(std::atomic_load(&m_combinedRules));
+	const std::shared_ptr<const CombinedRules> currentCombinedRules(cache->rules.value(key));
+
+	if (!currentCombinedRules || currentCombinedRules->snapshots != combinedRules->snapshots)
+	{
+		return;
+	}
+
+	combinedRules->generation = currentCombinedRules->generation;
+
+	std::shared_ptr<CombinedRulesCache> updatedCache(std::make_shared<CombinedRulesCache>(*cache));
+	updatedCache->rules[key] = combinedRules;
+
+	std::atomic_store(&m_combinedRules, std::shared_ptr<const CombinedRulesCache>(updatedCache));
+}
+
+void AdblockContentFiltersProfile::updateCombinedRules(const AdblockContentFiltersProfile *profile)
+{
+	QMutexLocker locker(&m_combinedRulesMutex);
+	const std::shared_ptr<const CombinedRulesCache> cache(std::atomic_load(&m_combinedRules));
+	const std::shared_ptr<const RulesSnapshot> snapshot(profile->getSnapshot());
+	const quint64 generation(m_combinedRulesGeneration.load(std::memory_order_relaxed) + 1);
+	std::shared_ptr<CombinedRulesCache> updatedCache(std::make_shared<CombinedRulesCache>());
+	updatedCache->rules.reserve(cache->rules.count());
+	QVector<quint64> keys;
+	QHash<quint64, std::shared_ptr<const CombinedRules> >::const_iterator iterator;
+
+	for (iterator = cache->rules.constBegin(); iterator != cache->rules.constEnd(); ++iterator)
+	{
+		const int index(iterator.value()->profiles.indexOf(profile));
+
+		if (index >= 0 && !snapshot)
+		{
+			continue;
+		}
+
+		std::shared_ptr<CombinedRules> combinedRules;
+
+		if (index >= 0)
+		{
+			combinedRules = std::make_shared<CombinedRules>();
+			combinedRules->profiles = iterator.value()->profiles;
+			combinedRules->snapshots = iterator.value()->snapshots;
+			combinedRules->snapshots[index] = snapshot;
+
+			if (combinedRules->profiles.count() > 1)
 			{
-				return currentResult;
+				keys.append(iterator.key());
 			}
 		}
+		else
+		{
+			combinedRules = std::make_shared<CombinedRules>(*iterator.value());
+		}
+
+		combinedRules->generation = generation;
+
+		updatedCache->rules.insert(iterator.key(), combinedRules);
+	}
+
+	m_combinedRulesGeneration.store(generation, std::memory_order_release);
+
+	std::atomic_store(&m_combinedRules, std::shared_ptr<const CombinedRulesCache>(updatedCache));
+
+	locker.unlock();
+
+	for (int i = 0; i < keys.count(); ++i)
+	{
+		QtConcurrent::run(&AdblockContentFiltersProfile::createCombinedRules, keys.at(i));
+	}
+}
+
+QString AdblockContentFiltersProfile::getPath() const
+{
+	return SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.txt")).arg(getName());
+}
+
+QString AdblockContentFiltersProfile::getCachePath() const
+{
+	return SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.dat")).arg(getName());
+}
+
+AdblockContentFiltersProfile::HeaderInformation AdblockContentFiltersProfile::loadHeader(QIODevice *rulesDevice)
+{
+	HeaderInformation information;
+	QTextStream stream(rulesDevice);
+	stream.setCodec("UTF-8");
+
+	const QString header(stream.readLine());
+
+	if (!header.contains(QLatin1String("[Adblock"), Qt::CaseInsensitive))
+	{
+		information.errorString = QCoreApplication::translate("main", "Failed to update content blocking profile: invalid header");
+		information.error = ParseError;
+
+		return information;
+	}
+
+	int lineNumber(1);
+
+	while (!stream.atEnd())
+	{
+		const QString line(stream.readLine().trimmed());
+
+		if (line.startsWith(QLatin1String("! Title: ")))
+		{
+			information.title = line.section(QLatin1Char(':'), 1).trimmed();
+
+			continue;
+		}
+
+		if (lineNumber > 50)
+		{
+			break;
+		}
+
+		++lineNumber;
+	}
+
+	return information;
+}
+
+ContentFiltersManager::CheckResult AdblockContentFiltersProfile::evaluateRule(const RulesSnapshot &snapshot, const Rule &rule, const Request &request) const
+{
+	ContentFiltersManager::CheckResult result;
+	const int lastStart((rule.ruleMatch == StartMatch || rule.ruleMatch == ExactMatch) ? 0 : request.requestUrl.length());
+
+	for (int i = 0; i <= lastStart; ++i)
+	{
+		int end(i);
+
+		if (!matchPattern(snapshot, rule, i, request.requestUrl, end))
+		{
+			continue;
+		}
+
+		const ContentFiltersManager::CheckResult currentResult(checkRuleMatch(snapshot, rule, request.requestUrl.midRef(i, (end - i)), request));
+
+		if (currentResult.isBlocked)
+		{
+			result = currentResult;
+		}
+		else if (currentResult.isException)
+		{
+			return currentResult;
+		}
+
+		if (!rule.isWildcard)
+		{
+			break;
+		}
 	}
 
 	return result;
 }
 
 ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType)
+{
+	if (!getSnapshot())
+	{
+		load();
+
+		return {};
+	}
+
+	return checkUrl(QVector<AdblockContentFiltersProfile*>({this}), baseUrl, requestUrl, resourceType);
+}
+
+ContentFiltersManager::CheckResult AdblockContentFiltersProfile::checkUrl(const QVector<AdblockContentFiltersProfile*> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType)
 {
 	ContentFiltersManager::CheckResult result;
 
-	if (!m_wasLoaded && !loadRules())
+	if (profiles.isEmpty())
 	{
 		return result;
 	}
 
+	const std::shared_ptr<const CombinedRules> combinedRules(getCombinedRules(profiles));
 	const Request request(baseUrl, requestUrl, resourceType);
+	QVarLengthArray<quint64, 64> evaluatedRules;
+	quint64 token(0);
 
 	for (int i = 0; i < request.requestUrl.length(); ++i)
 	{
-		const ContentFiltersManager::CheckResult currentResult(checkUrlSubstring(m_root, request.requestUrl.right(request.requestUrl.length() - i), {}, request));
+		token = ((token << 16) | request.requestUrl.at(i).unicode());
 
-		if (currentResult.isBlocked)
+		if (i < (m_tokenLength - 1))
 		{
-			result = currentResult;
+			continue;
 		}
-		else if (currentResult.isException)
+
+		if (combinedRules->isMerged)
 		{
-			return currentResult;
+			const QHash<quint64, QVector<RuleReference> >::const_iterator iterator(combinedRules->tokens.constFind(token));
+
+			if (iterator == combinedRules->tokens.constEnd())
+			{
+				continue;
+			}
+
+			const QVector<RuleReference> &candidates(iterator.value());
+
+			for (int j = 0; j < candidates.count(); ++j)
+			{
+				if (checkRule(*combinedRules, candidates.at(j), i, request, evaluatedRules, result))
+				{
+					return result;
+				}
+			}
+
+			continue;
+		}
+
+		for (int j = 0; j < combinedRules->snapshots.count(); ++j)
+		{
+			const RulesSnapshot *snapshot(combinedRules->snapshots.at(j).get());
+
+			if (!snapshot)
+			{
+				continue;
+			}
+
+			const QHash<quint64, TokenRange>::const_iterator iterator(snapshot->tokens.constFind(token));
+
+			if (iterator == snapshot->tokens.constEnd())
+			{
+				continue;
+			}
+
+			const TokenRange &range(iterator.value());
+
+			for (int k = 0; k < range.amount; ++k)
+			{
+				RuleReference reference;
+				reference.profile = j;
+				reference.rule = snapshot->tokenRules.at(range.offset + k);
+
+				if (checkRule(*combinedRules, reference, i, request, evaluatedRules, result))
+				{
+					return result;
+				}
+			}
+		}
+	}
+
+	if (combinedRules->isMerged)
+	{
+		for (int i = 0; i < combinedRules->untokenizedRules.count(); ++i)
+		{
+			if (checkRule(*combinedRules, combinedRules->untokenizedRules.at(i), -1, request, evaluatedRules, result))
+			{
+				return result;
+			}
+		}
+
+		return result;
+	}
+
+	for (int i = 0; i < combinedRules->snapshots.count(); ++i)
+	{
+		const RulesSnapshot *snapshot(combinedRules->snapshots.at(i).get());
+
+		if (!snapshot)
+		{
+			continue;
+		}
+
+		for (int j = 0; j < snapshot->untokenizedRules.count(); ++j)
+		{
+			RuleReference reference;
+			reference.profile = i;
+			reference.rule = snapshot->untokenizedRules.at(j);
+
+			if (checkRule(*combinedRules, reference, -1, request, evaluatedRules, result))
+			{
+				return result;
+			}
 		}
 	}
 
 	return result;
 }
 
+bool AdblockContentFiltersProfile::checkRule(const CombinedRules &combinedRules, const RuleReference &reference, int position, const Request &request, QVarLengthArray<quint64, 64> &evaluatedRules, ContentFiltersManager::CheckResult &result)
+{
+	const quint64 identifier((static_cast<quint64>(reference.profile) << 32) | static_cast<quint32>(reference.rule));
+
+	for (int i = 0; i < evaluatedRules.count(); ++i)
+	{
+		if (evaluatedRules.at(i) == identifier)
+		{
+			return false;
+		}
+	}
+
+	const AdblockContentFiltersProfile *profile(combinedRules.profiles.at(reference.profile));
+	const RulesSnapshot &snapshot(*combinedRules.snapshots.at(reference.profile));
+	const Rule &rule(snapshot.rules.at(reference.rule));
+	ContentFiltersManager::CheckResult currentResult;
+
+	if (position >= 0 && rule.tokenOffset >= 0)
+	{
+		const int start(position - m_tokenLength + 1 - rule.tokenOffset);
+		int end(start);
+
+		if (start < 0 || !profile->matchPattern(snapshot, rule, start, request.requestUrl, end))
+		{
+			return false;
+		}
+
+		if (!rule.isWildcard)
+		{
+			evaluatedRules.append(identifier);
+		}
+
+		currentResult = profile->checkRuleMatch(snapshot, rule, request.requestUrl.midRef(start, (end - start)), request);
+	}
+	else
+	{
+		if (position >= 0)
+		{
+			evaluatedRules.append(identifier);
+		}
+
+		currentResult = profile->evaluateRule(snapshot, rule, request);
+	}
+
+	currentResult.profile = reference.profile;
+
+	if (currentResult.isException)
+	{
+		result = currentResult;
+
+		return true;
+	}
+
+	if (currentResult.isBlocked && (!result.isBlocked || reference.profile >= result.profile))
+	{
+		result = currentResult;
+	}
+
+	return false;
+}
+
 ContentFiltersManager::CosmeticFiltersResult AdblockContentFiltersProfile::getCosmeticFilters(const QStringList &domains, bool isDomainOnly)
 {
-	if (!m_wasLoaded)
+	const std::shared_ptr<const RulesSnapshot> snapshot(getSnapshot());
+
+	if (!snapshot)
 	{
-		loadRules();
+		load();
+
+		return {};
 	}
 
 	ContentFiltersManager::CosmeticFiltersResult result;
 
 	if (!isDomainOnly)
 	{
-		result.rules = m_cosmeticFiltersRules;
+		result.rules.reserve(snapshot->cosmeticFiltersGenericRules.count());
+
+		for (int i = 0; i < snapshot->cosmeticFiltersGenericRules.count(); ++i)
+		{
+			result.rules.append(snapshot->cosmeticFiltersRules.at(snapshot->cosmeticFiltersGenericRules.at(i)));
+		}
+	}
+
+	for (int i = 0; i < domains.count(); ++i)
+	{
+		result.rules.append(snapshot->cosmeticFiltersDomainRules.values(domains.at(i)));
+		result.exceptions.append(snapshot->cosmeticFiltersDomainExceptions.values(domains.at(i)));
+	}
+
+	return result;
+}
+
+ContentFiltersManager::CosmeticFiltersResult AdblockContentFiltersProfile::getCosmeticFilters(const QStringList &domains, const QStringList &identifiers, const QStringList &classes)
+{
+	const std::shared_ptr<const RulesSnapshot> snapshot(getSnapshot());
+
+	if (!snapshot)
+	{
+		load();
+
+		return {};
+	}
+
+	ContentFiltersManager::CosmeticFiltersResult result;
+
+	for (int i = 0; i < identifiers.count(); ++i)
+	{
+		QMultiHash<QString, int>::const_iterator iterator(snapshot->cosmeticFiltersIdentifierRules.constFind(identifiers.at(i)));
+
+		while (iterator != snapshot->cosmeticFiltersIdentifierRules.constEnd() && iterator.key() == identifiers.at(i))
+		{
+			result.rules.append(snapshot->cosmeticFiltersRules.at(iterator.value()));
+
+			++iterator;
+		}
+	}
+
+	for (int i = 0; i < classes.count(); ++i)
+	{
+		QMultiHash<QString, int>::const_iterator iterator(snapshot->cosmeticFiltersClassRules.constFind(classes.at(i)));
+
+		while (iterator != snapshot->cosmeticFiltersClassRules.constEnd() && iterator.key() == classes.at(i))
+		{
+			result.rules.append(snapshot->cosmeticFiltersRules.at(iterator.value()));
+
+			++iterator;
+		}
 	}
 
 	for (int i = 0; i < domains.count(); ++i)
 	{
-		result.rules.append(m_cosmeticFiltersDomainRules.values(domains.at(i)));
-		result.exceptions.append(m_cosmeticFiltersDomainExceptions.values(domains.at(i)));
+		result.exceptions.append(snapshot->cosmeticFiltersDomainExceptions.values(domains.at(i)));
 	}
 
 	return result;
@@ -880,34 +1583,67 @@ QVector<QLocale::Language> AdblockContentFiltersProfile::getLanguages() const
 	return m_languages;
 }
 
-ContentFiltersProfile::ProfileCategory AdblockContentFiltersProfile::getCategory() const
-{
-	return m_profileSummary.category;
-}
-
 ContentFiltersManager::CosmeticFiltersMode AdblockContentFiltersProfile::getCosmeticFiltersMode() const
 {
-	return m_profileSummary.cosmeticFiltersMode;
+	return getProfileSummary().cosmeticFiltersMode;
 }
 
-ContentFiltersProfile::ProfileError AdblockContentFiltersProfile::getError() const
+quint64 AdblockContentFiltersProfile::getMemoryUsage() const
 {
-	return m_error;
-}
+	const std::shared_ptr<const RulesSnapshot> snapshot(getSnapshot());
 
-ContentFiltersProfile::ProfileFlags AdblockContentFiltersProfile::getFlags() const
-{
-	return m_flags;
-}
+	if (!snapshot)
+	{
+		return 0;
+	}
 
-int AdblockContentFiltersProfile::getUpdateInterval() const
-{
-	return m_profileSummary.updateInterval;
-}
+	const quint64 hashNodeSize(sizeof(void*) * 2);
+	quint64 usage(sizeof(RulesSnapshot));
+	usage += (static_cast<quint64>(snapshot->text.capacity()) * sizeof(QChar));
+	usage += (static_cast<quint64>(snapshot->rules.capacity()) * sizeof(Rule));
+	usage += (static_cast<quint64>(snapshot->untokenizedRules.capacity() + snapshot->tokenRules.capacity()) * sizeof(int));
+	usage += (static_cast<quint64>(snapshot->ruleDomains.capacity()) * sizeof(quint32));
+	usage += (static_cast<quint64>(snapshot->tokens.count()) * (hashNodeSize + sizeof(quint64) + sizeof(TokenRange)));
 
-int AdblockContentFiltersProfile::getUpdateProgress() const
-{
-	return (m_dataFetchJob ? m_dataFetchJob->getProgress() : -1);
+	QHash<QString, quint32>::const_iterator domainsIterator;
+
+	for (domainsIterator = snapshot->domains.constBegin(); domainsIterator != snapshot->domains.constEnd(); ++domainsIterator)
+	{
+		usage += (hashNodeSize + sizeof(QString) + sizeof(quint32) + (static_cast<quint64>(domainsIterator.key().capacity()) * sizeof(QChar)));
+	}
+
+	for (int i = 0; i < snapshot->cosmeticFiltersRules.count(); ++i)
+	{
+		usage += (sizeof(QString) + (static_cast<quint64>(snapshot->cosmeticFiltersRules.at(i).capacity()) * sizeof(QChar)));
+	}
+
+	usage += (static_cast<quint64>(snapshot->cosmeticFiltersGenericRules.capacity()) * sizeof(int));
+
+	QMultiHash<QString, int>::const_iterator cosmeticFiltersIndexIterator;
+
+	for (cosmeticFiltersIndexIterator = snapshot->cosmeticFiltersIdentifierRules.constBegin(); cosmeticFiltersIndexIterator != snapshot->cosmeticFiltersIdentifierRules.constEnd(); ++cosmeticFiltersIndexIterator)
+	{
+		usage += (hashNodeSize + sizeof(QString) + sizeof(int) + (static_cast<quint64>(cosmeticFiltersIndexIterator.key().capacity()) * sizeof(QChar)));
+	}
+
+	for (cosmeticFiltersIndexIterator = snapshot->cosmeticFiltersClassRules.constBegin(); cosmeticFiltersIndexIterator != snapshot->cosmeticFiltersClassRules.constEnd(); ++cosmeticFiltersIndexIterator)
+	{
+		usage += (hashNodeSize + sizeof(QString) + sizeof(int) + (static_cast<quint64>(cosmeticFiltersIndexIterator.key().capacity()) * sizeof(QChar)));
+	}
+
+	QMultiHash<QString, QString>::const_iterator cosmeticFiltersIterator;
+
+	for (cosmeticFiltersIterator = snapshot->cosmeticFiltersDomainRules.constBegin(); cosmeticFiltersIterator != snapshot->cosmeticFiltersDomainRules.constEnd(); ++cosmeticFiltersIterator)
+	{
+		usage += (hashNodeSize + (sizeof(QString) * 2) + (static_cast<quint64>(cosmeticFiltersIterator.key().capacity() + cosmeticFiltersIterator.value().capacity()) * sizeof(QChar)));
+	}
+
+	for (cosmeticFiltersIterator = snapshot->cosmeticFiltersDomainExceptions.constBegin(); cosmeticFiltersIterator != snapshot->cosmeticFiltersDomainExceptions.constEnd(); ++cosmeticFiltersIterator)
+	{
+		usage += (hashNodeSize + (sizeof(QString) * 2) + (static_cast<quint64>(cosmeticFiltersIterator.key().capacity() + cosmeticFiltersIterator.value().capacity()) * sizeof(QChar)));
+	}
+
+	return usage;
 }
 
 bool AdblockContentFiltersProfile::create(const ContentFiltersProfile::ProfileSummary &profileSummary, QIODevice *rulesDevice, bool canOverwriteExisting)
@@ -957,105 +1693,273 @@ bool AdblockContentFiltersProfile::create(const ContentFiltersProfile::ProfileSu
 	return true;
 }
 
-bool AdblockContentFiltersProfile::loadRules()
+QVector<quint64> AdblockContentFiltersProfile::getRuleTokens(const RulesSnapshot &snapshot, const Rule &rule, bool isLeadingOnly) const
+{
+	const QChar *pattern(snapshot.text.constData() + rule.patternOffset);
+	QVector<quint64> tokens;
+	quint64 token(0);
+	int length(0);
+
+	for (int i = 0; i < rule.patternLength; ++i)
+	{
+		const QChar character(pattern[i]);
+
+		if (character == QLatin1Char('*'))
+		{
+			if (isLeadingOnly)
+			{
+				break;
+			}
+
+			length = 0;
+
+			continue;
+		}
+
+		if (character == QLatin1Char('^'))
+		{
+			length = 0;
+
+			continue;
+		}
+
+		token = ((token << 16) | character.unicode());
+
+		++length;
+
+		if (length >= m_tokenLength && !tokens.contains(token))
+		{
+			tokens.append(token);
+		}
+	}
+
+	return tokens;
+}
+
+void AdblockContentFiltersProfile::loadData(bool isUpdate)
 {
 	const QString path(getPath());
 
-	m_error = NoError;
+	resetError();
 
-	if (!QFile::exists(path) && !m_profileSummary.updateUrl.isEmpty())
+	if (!QFile::exists(path) && !getUpdateUrl().isEmpty())
 	{
-		update();
+		startLoading();
+
+		if (!isUpdating() && !update())
+		{
+			finishLoading();
+		}
+
+		return;
+	}
+
+	const quint64 generation(startLoading());
+
+	addLoadingFuture(QtConcurrent::run(this, &AdblockContentFiltersProfile::createSnapshot, path, getCachePath(), getProfileSummary(), generation, isUpdate));
+}
 
+bool AdblockContentFiltersProfile::loadCache(RulesSnapshot &snapshot, const QString &path, const CacheKey &key) const
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
 		return false;
 	}
 
-	m_wasLoaded = true;
+	const qint64 size(file.size());
+	uchar *mapping(file.map(0, size));
 
-	if (m_domainExpression.pattern().isEmpty())
+	if (!mapping)
 	{
-		m_domainExpression = QRegularExpression(QLatin1String("[:\?&/=]"));
-		m_domainExpression.optimize();
+		return false;
 	}
 
-	QFile file(path);
-	file.open(QIODevice::ReadOnly | QIODevice::Text);
+	const QByteArray data(QByteArray::fromRawData(reinterpret_cast<const char*>(mapping), static_cast<int>(size)));
+	QDataStream stream(data);
+	stream.setVersion(QDataStream::Qt_5_6);
 
-	QTextStream stream(&file);
-	stream.setCodec("UTF-8");
-	stream.readLine(); // header
+	quint32 magic(0);
+	quint32 version(0);
+	quint32 ruleLayoutVersion(0);
+	quint32 ruleSize(0);
 
-	m_root = new Node();
+	stream >> magic >> version >> ruleLayoutVersion >> ruleSize;
 
-	while (!stream.atEnd())
+	if (magic != m_cacheMagic || version != m_cacheVersion || ruleLayoutVersion != m_ruleLayoutVersion || ruleSize != sizeof(Rule))
 	{
-		parseRuleLine(stream.readLine());
+		file.unmap(mapping);
+
+		return false;
 	}
 
+	CacheKey cachedKey;
+	quint8 cosmeticFiltersMode(0);
+	bool areWildcardsEnabled(false);
+	quint32 amount(0);
+
+	stream >> cachedKey.size >> cachedKey.lastModified >> cachedKey.checksum >> cosmeticFiltersMode >> areWildcardsEnabled >> amount;
+
+	const bool isMatching(key.checksum.isEmpty() ? (cachedKey.size == key.size && cachedKey.lastModified == key.lastModified) : cachedKey.checksum == key.checksum);
+
+	if (!isMatching || cosmeticFiltersMode != static_cast<quint8>(snapshot.cosmeticFiltersMode) || areWildcardsEnabled != snapshot.areWildcardsEnabled || static_cast<quint64>(amount) * sizeof(Rule) > static_cast<quint64>(size))
+	{
+		file.unmap(mapping);
+
+		return false;
+	}
+
+	snapshot.rules.resize(static_cast<int>(amount));
+
+	stream.readRawData(reinterpret_cast<char*>(snapshot.rules.data()), static_cast<int>(amount * sizeof(Rule)));
+
+	QVector<QString> domains;
+	QVector<quint64> tokens;
+	QVector<qint32> ranges;
+
+	stream >> snapshot.text >> snapshot.untokenizedRules >> snapshot.tokenRules >> snapshot.ruleDomains >> domains >> tokens >> ranges >> snapshot.cosmeticFiltersRules >> snapshot.cosmeticFiltersDomainRules >> snapshot.cosmeticFiltersDomainExceptions >> snapshot.cosmeticFiltersLines;
+
+	file.unmap(mapping);
 	file.close();
 
+	if (stream.status() != QDataStream::Ok || ranges.count() != (tokens.count() * 2))
+	{
+		return false;
+	}
+
+	snapshot.domains.reserve(domains.count());
+
+	for (int i = 0; i < domains.count(); ++i)
+	{
+		snapshot.domains.insert(domains.at(i), static_cast<quint32>(i));
+	}
+
+	snapshot.tokens.reserve(tokens.count());
+
+	for (int i = 0; i < tokens.count(); ++i)
+	{
+		TokenRange range;
+		range.offset = ranges.at(i * 2);
+		range.amount = ranges.at((i * 2) + 1);
+
+		snapshot.tokens.insert(tokens.at(i), range);
+	}
+
 	return true;
 }
 
-bool AdblockContentFiltersProfile::update(const QUrl &url)
+bool AdblockContentFiltersProfile::matchPattern(const RulesSnapshot &snapshot, const Rule &rule, int start, const QString &url, int &end) const
 {
-	if (m_dataFetchJob || thread() != QThread::currentThread())
+	if (start != 0 && (rule.ruleMatch == StartMatch || rule.ruleMatch == ExactMatch))
 	{
 		return false;
 	}
 
-	const QUrl updateUrl(url.isValid() ? url : m_profileSummary.updateUrl);
+	const QChar *pattern(snapshot.text.constData() + rule.patternOffset);
+	const bool isAnchoredToEnd(rule.ruleMatch == EndMatch || rule.ruleMatch == ExactMatch);
+	int patternPosition(0);
+	int urlPosition(start);
+	int wildcardPatternPosition(-1);
+	int wildcardUrlPosition(-1);
 
-	if (!updateUrl.isValid())
+	while (true)
 	{
-		if (updateUrl.isEmpty())
+		if (patternPosition == rule.patternLength)
 		{
-			raiseError(QCoreApplication::translate("main", "Failed to update content blocking profile, update URL is empty"), DownloadError);
+			if (!isAnchoredToEnd || urlPosition == url.length())
+			{
+				end = urlPosition;
+
+				return true;
+			}
 		}
 		else
 		{
-			raiseError(QCoreApplication::translate("main", "Failed to update content blocking profile, update URL (%1) is invalid").arg(updateUrl.toString()), DownloadError);
-		}
+			const QChar character(pattern[patternPosition]);
 
-		return false;
-	}
+			if (character == QLatin1Char('*'))
+			{
+				++patternPosition;
 
-	m_dataFetchJob = new DataFetchJob(updateUrl, this);
+				wildcardPatternPosition = patternPosition;
+				wildcardUrlPosition = urlPosition;
 
-	connect(m_dataFetchJob, &Job::jobFinished, this, &AdblockContentFiltersProfile::handleJobFinished);
-	connect(m_dataFetchJob, &Job::progressChanged, this, &AdblockContentFiltersProfile::updateProgressChanged);
+				continue;
+			}
 
-	m_dataFetchJob->start();
+			if (character == QLatin1Char('^'))
+			{
+				if (urlPosition == url.length() || isSeparator(url.at(urlPosition)))
+				{
+					++patternPosition;
 
-	emit profileModified();
+					continue;
+				}
+			}
+			else if (urlPosition < url.length() && url.at(urlPosition) == character)
+			{
+				++patternPosition;
+				++urlPosition;
 
-	return true;
+				continue;
+			}
+		}
+
+		if (wildcardPatternPosition < 0 || wildcardUrlPosition >= url.length())
+		{
+			return false;
+		}
+
+		++wildcardUrlPosition;
+
+		patternPosition = wildcardPatternPosition;
+		urlPosition = wildcardUrlPosition;
+	}
+
+	return false;
 }
 
 bool AdblockContentFiltersProfile::remove()
 {
-	const QString path(getPath());
-
-	if (m_dataFetchJob)
+	if (QFile::exists(getCachePath()))
 	{
-		m_dataFetchJob->cancel();
-		m_dataFetchJob->deleteLater();
-		m_dataFetchJob = nullptr;
+		QFile::remove(getCachePath());
 	}
 
-	if (QFile::exists(path))
+	return ContentFiltersProfile::remove();
+}
+
+bool AdblockContentFiltersProfile::validateData(const QByteArray &data)
+{
+	QBuffer buffer;
+	buffer.setData(data);
+	buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+
+	const HeaderInformation information(loadHeader(&buffer));
+
+	if (information.error != NoError)
 	{
-		return QFile::remove(path);
+		raiseError(information.errorString, information.error);
+
+		return false;
 	}
 
+	setDefaultTitle(information.title);
+
 	return true;
 }
 
-bool AdblockContentFiltersProfile::resolveDomainExceptions(const QString &url, const QStringList &ruleList) const
+bool AdblockContentFiltersProfile::resolveDomainExceptions(const RulesSnapshot &snapshot, const QStringList &domains, int offset, int amount) const
 {
-	for (int i = 0; i < ruleList.count(); ++i)
+	const quint32 *begin(snapshot.ruleDomains.constData() + offset);
+	const quint32 *end(begin + amount);
+
+	for (int i = 0; i < domains.count(); ++i)
 	{
-		if (url.contains(ruleList.at(i)))
+		const QHash<QString, quint32>::const_iterator iterator(snapshot.domains.constFind(domains.at(i)));
+
+		if (iterator != snapshot.domains.constEnd() && std::binary_search(begin, end, iterator.value()))
 		{
 			return true;
 		}
@@ -1064,9 +1968,14 @@ bool AdblockContentFiltersProfile::resolveDomainExceptions(const QString &url, c
 	return false;
 }
 
+bool AdblockContentFiltersProfile::isSeparator(QChar character) const
+{
+	return (!character.isDigit() && !character.isLetter() && !m_separators.contains(character));
+}
+
 bool AdblockContentFiltersProfile::areWildcardsEnabled() const
 {
-	return m_profileSummary.areWildcardsEnabled;
+	return getProfileSummary().areWildcardsEnabled;
 }
 
 bool AdblockContentFiltersProfile::isFraud(const QUrl &url)
@@ -1076,9 +1985,9 @@ bool AdblockContentFiltersProfile::isFraud(const QUrl &url)
 	return false;
 }
 
-bool AdblockContentFiltersProfile::isUpdating() const
+bool AdblockContentFiltersProfile::isLoaded() const
 {
-	return (m_dataFetchJob != nullptr);
+	return (getSnapshot() != nullptr);
 }
 
 }
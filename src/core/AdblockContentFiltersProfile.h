@@ -24,13 +24,16 @@
 
 #include "ContentFiltersManager.h"
 
-#include <QtCore/QRegularExpression>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QVarLengthArray>
+
+#include <atomic>
+#include <memory>
 
 namespace Otter
 {
 
-class DataFetchJob;
-
 class AdblockContentFiltersProfile final : public ContentFiltersProfile
 {
 	Q_OBJECT
@@ -53,32 +56,23 @@ public:
 	};
 
 	explicit AdblockContentFiltersProfile(const ProfileSummary &profileSummary, const QStringList &languages, ProfileFlags flags, QObject *parent = nullptr);
+	~AdblockContentFiltersProfile();
 
-	void clear() override;
-	void setProfileSummary(const ProfileSummary &profileSummary) override;
-	QString getName() const override;
-	QString getTitle() const override;
 	QString getPath() const override;
-	QUrl getUpdateUrl() const override;
-	QDateTime getLastUpdate() const override;
 	static HeaderInformation loadHeader(QIODevice *rulesDevice);
-	ProfileSummary getProfileSummary() const override;
 	ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) override;
+	static ContentFiltersManager::CheckResult checkUrl(const QVector<AdblockContentFiltersProfile*> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType);
 	ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, bool isDomainOnly) override;
+	ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, const QStringList &identifiers, const QStringList &classes) override;
 	static QHash<RuleType, quint32> loadRulesInformation(const ProfileSummary &profileSummary, QIODevice *rulesDevice);
 	QVector<QLocale::Language> getLanguages() const override;
-	ProfileCategory getCategory() const override;
 	ContentFiltersManager::CosmeticFiltersMode getCosmeticFiltersMode() const override;
-	ProfileError getError() const override;
-	ProfileFlags getFlags() const override;
-	int getUpdateInterval() const override;
-	int getUpdateProgress() const override;
+	quint64 getMemoryUsage() const override;
 	static bool create(const ProfileSummary &profileSummary, QIODevice *rulesDevice = nullptr, bool canOverwriteExisting = false);
-	bool update(const QUrl &url = {}) override;
 	bool remove() override;
 	bool areWildcardsEnabled() const override;
 	bool isFraud(const QUrl &url) override;
-	bool isUpdating() const override;
+	bool isLoaded() const override;
 
 protected:
 	enum RuleOption : quint16
@@ -108,23 +102,76 @@ protected:
 		ExactMatch
 	};
 
-	struct Node final
+	struct Rule final
 	{
-		struct Rule final
-		{
-			QString rule;
-			QStringList blockedDomains;
-			QStringList allowedDomains;
-			RuleOptions ruleOptions = NoOption;
-			RuleOptions ruleExceptions = NoOption;
-			RuleMatch ruleMatch = ContainsMatch;
-			bool isException = false;
-			bool needsDomainCheck = false;
-		};
-
-		QChar value = 0;
-		QVarLengthArray<Node*, 1> children;
-		QVarLengthArray<Rule*, 1> rules;
+		int ruleOffset = 0;
+		int ruleLength = 0;
+		int patternOffset = 0;
+		int patternLength = 0;
+		int domainsOffset = 0;
+		int tokenOffset = -1;
+		quint16 blockedDomainsAmount = 0;
+		quint16 allowedDomainsAmount = 0;
+		RuleOptions ruleOptions = NoOption;
+		RuleOptions ruleExceptions = NoOption;
+		RuleMatch ruleMatch = ContainsMatch;
+		bool isException = false;
+		bool isWildcard = false;
+		bool needsDomainCheck = false;
+	};
+
+	struct CacheKey final
+	{
+		QByteArray checksum;
+		qint64 size = 0;
+		qint64 lastModified = 0;
+	};
+
+	struct TokenRange final
+	{
+		int offset = 0;
+		int amount = 0;
+	};
+
+	struct RulesSnapshot final
+	{
+		QString text;
+		QVector<Rule> rules;
+		QVector<int> untokenizedRules;
+		QVector<int> tokenRules;
+		QVector<quint32> ruleDomains;
+		QHash<quint64, TokenRange> tokens;
+		QHash<QString, quint32> domains;
+		QStringList cosmeticFiltersRules;
+		QVector<int> cosmeticFiltersGenericRules;
+		QMultiHash<QString, int> cosmeticFiltersIdentifierRules;
+		QMultiHash<QString, int> cosmeticFiltersClassRules;
+		QMultiHash<QString, QString> cosmeticFiltersDomainRules;
+		QMultiHash<QString, QString> cosmeticFiltersDomainExceptions;
+		QVector<uint> cosmeticFiltersLines;
+		ContentFiltersManager::CosmeticFiltersMode cosmeticFiltersMode = ContentFiltersManager::AllFilters;
+		bool areWildcardsEnabled = false;
+	};
+
+	struct RuleReference final
+	{
+		int profile = 0;
+		int rule = 0;
+	};
+
+	struct CombinedRules final
+	{
+		QVector<const AdblockContentFiltersProfile*> profiles;
+		QVector<std::shared_ptr<const RulesSnapshot> > snapshots;
+		QVector<RuleReference> untokenizedRules;
+		QHash<quint64, QVector<RuleReference> > tokens;
+		quint64 generation = 0;
+		bool isMerged = false;
+	};
+
+	struct CombinedRulesCache final
+	{
+		QHash<quint64, std::shared_ptr<const CombinedRules> > rules;
 	};
 
 	struct Request final
@@ -132,9 +179,11 @@ protected:
 		QString baseHost;
 		QString requestHost;
 		QString requestUrl;
+		QStringList baseSubdomains;
+		QStringList requestSubdomains;
 		NetworkManager::ResourceType resourceType = NetworkManager::OtherType;
 
-		explicit Request(const QUrl &baseUrlValue, const QUrl &requestUrlValue, NetworkManager::ResourceType resourceTypeValue) : baseHost(baseUrlValue.host()), requestHost(requestUrlValue.host()), requestUrl(requestUrlValue.toString()), resourceType(resourceTypeValue)
+		explicit Request(const QUrl &baseUrlValue, const QUrl &requestUrlValue, NetworkManager::ResourceType resourceTypeValue) : baseHost(baseUrlValue.host()), requestHost(requestUrlValue.host()), requestUrl(requestUrlValue.toString()), baseSubdomains(ContentFiltersManager::createSubdomainList(baseHost)), requestSubdomains(ContentFiltersManager::createSubdomainList(requestHost)), resourceType(resourceTypeValue)
 		{
 			if (requestUrl.startsWith(QLatin1String("//")))
 			{
@@ -144,35 +193,53 @@ protected:
 	};
 
 	void loadHeader();
-	void parseRuleLine(const QString &rule);
-	void parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list);
-	void deleteNode(Node *node) const;
-	ContentFiltersManager::CheckResult checkUrlSubstring(const Node *node, const QString &subString, QString currentRule, const Request &request) const;
-	ContentFiltersManager::CheckResult checkRuleMatch(const Node::Rule *rule, const QString &currentRule, const Request &request) const;
-	ContentFiltersManager::CheckResult evaluateNodeRules(const Node *node, const QString &currentRule, const Request &request) const;
-	bool loadRules();
-	bool resolveDomainExceptions(const QString &url, const QStringList &ruleList) const;
+	void parseRuleLine(const QString &rule, RulesSnapshot &snapshot) const;
+	void parseStyleSheetRule(const QStringList &line, QMultiHash<QString, QString> &list) const;
+	void createTokensIndex(RulesSnapshot &snapshot, const QVector<quint64> &knownTokens = {}) const;
+	void createCosmeticFiltersIndex(RulesSnapshot &snapshot) const;
+	void createSnapshot(const QString &path, const QString &cachePath, const ProfileSummary &profileSummary, quint64 generation, bool isUpdate);
+	void copyRule(const RulesSnapshot &source, const Rule &rule, RulesSnapshot &target) const;
+	void compactDomains(RulesSnapshot &snapshot) const;
+	void saveCache(const RulesSnapshot &snapshot, const QString &path, const CacheKey &key) const;
+	void clearSnapshot() override;
+	void setSnapshot(const std::shared_ptr<const RulesSnapshot> &snapshot);
+	static void createCombinedRules(quint64 key);
+	static void updateCombinedRules(const AdblockContentFiltersProfile *profile);
+	QString getCachePath() const;
+	std::shared_ptr<const RulesSnapshot> getSnapshot() const;
+	static std::shared_ptr<const CombinedRules> getCombinedRules(const QVector<AdblockContentFiltersProfile*> &profiles);
+	static std::shared_ptr<const CombinedRules> getCachedCombinedRules(const CombinedRulesCache &cache, quint64 key, const QVector<AdblockContentFiltersProfile*> &profiles);
+	static quint64 getCombinedRulesKey(const QVector<AdblockContentFiltersProfile*> &profiles);
+	ContentFiltersManager::CheckResult checkRuleMatch(const RulesSnapshot &snapshot, const Rule &rule, const QStringRef &currentRule, const Request &request) const;
+	ContentFiltersManager::CheckResult evaluateRule(const RulesSnapshot &snapshot, const Rule &rule, const Request &request) const;
+	QVector<quint64> getRuleTokens(const RulesSnapshot &snapshot, const Rule &rule, bool isLeadingOnly) const;
+	bool loadCache(RulesSnapshot &snapshot, const QString &path, const CacheKey &key) const;
+	bool validateData(const QByteArray &data) override;
+	bool matchPattern(const RulesSnapshot &snapshot, const Rule &rule, int start, const QString &url, int &end) const;
+	bool isSeparator(QChar character) const;
+	static bool checkRule(const CombinedRules &combinedRules, const RuleReference &reference, int position, const Request &request, QVarLengthArray<quint64, 64> &evaluatedRules, ContentFiltersManager::CheckResult &result);
+	bool resolveDomainExceptions(const RulesSnapshot &snapshot, const QStringList &domains, int offset, int amount) const;
 
 protected slots:
-	void raiseError(const QString &message, ProfileError error);
-	void handleJobFinished(bool isSuccess);
+	void loadData(bool isUpdate) override;
+	void handleRulesUpdated(int addedRules, int removedRules);
 
 private:
-	Node *m_root;
-	DataFetchJob *m_dataFetchJob;
-	ProfileSummary m_profileSummary;
-	QRegularExpression m_domainExpression;
-	QStringList m_cosmeticFiltersRules;
 	QVector<QLocale::Language> m_languages;
-	QMultiHash<QString, QString> m_cosmeticFiltersDomainRules;
-	QMultiHash<QString, QString> m_cosmeticFiltersDomainExceptions;
-	ProfileError m_error;
-	ProfileFlags m_flags;
-	bool m_wasLoaded;
+	std::shared_ptr<const RulesSnapshot> m_snapshot;
 
+	static const quint32 m_cacheMagic = 0x4f41424c;
+	static const quint32 m_cacheVersion = 5;
+	static const quint32 m_ruleLayoutVersion = 1;
+	static const int m_tokenLength = 4;
+	static const quint64 m_untokenizedToken = Q_UINT64_C(0xFFFFFFFFFFFFFFFF);
 	static QVector<QChar> m_separators;
+	static QVector<QChar> m_domainSeparators;
 	static QHash<QString, RuleOption> m_options;
 	static QHash<NetworkManager::ResourceType, RuleOption> m_resourceTypes;
+	static std::shared_ptr<const CombinedRulesCache> m_combinedRules;
+	static std::atomic<quint64> m_combinedRulesGeneration;
+	static QMutex m_combinedRulesMutex;
 };
 
 }
@@ -22,6 +22,7 @@
 #include "AddressCompletionModel.h"
 #include "AddonsManager.h"
 #include "BookmarksManager.h"
+#include "FaviconsManager.h"
 #include "HistoryManager.h"
 #include "SettingsManager.h"
 #include "ThemesManager.h"
@@ -40,6 +41,7 @@ AddressCompletionModel::AddressCompletionModel(QObject *parent) : QAbstractListM
 	m_updateTimer(0),
 	m_showCompletionCategories(true)
 {
+	connect(FaviconsManager::getInstance(), &FaviconsManager::iconChanged, this, &AddressCompletionModel::handleIconChanged);
 }
 
 void AddressCompletionModel::timerEvent(QTimerEvent *event)
@@ -113,7 +115,7 @@ void AddressCompletionModel::updateModel()
 
 		for (int i = 0; i < bookmarks.count(); ++i)
 		{
-			CompletionEntry completionEntry(bookmarks.at(i).bookmark->getUrl(), bookmarks.at(i).bookmark->getTitle(), bookmarks.at(i).match, bookmarks.at(i).bookmark->getIcon(), {}, CompletionEntry::BookmarkType);
+			CompletionEntry completionEntry(bookmarks.at(i).bookmark->getUrl(), bookmarks.at(i).bookmark->getTitle(), bookmarks.at(i).match, {}, {}, CompletionEntry::BookmarkType);
 			completionEntry.keyword = bookmarks.at(i).bookmark->getKeyword();
 
 			if (completionEntry.keyword.startsWith(m_filter))
@@ -163,7 +165,7 @@ void AddressCompletionModel::updateModel()
 
 		for (int i = 0; i < entries.count(); ++i)
 		{
-			completions.append(CompletionEntry(entries.at(i).entry->getUrl(), entries.at(i).entry->getTitle(), entries.at(i).match, entries.at(i).entry->getIcon(), entries.at(i).entry->getTimeVisited(), (entries.at(i).isTypedIn ? CompletionEntry::TypedInHistoryType : CompletionEntry::HistoryType)));
+			completions.append(CompletionEntry(entries.at(i).entry.url, entries.at(i).entry.getTitle(), entries.at(i).match, {}, entries.at(i).entry.timeVisited, (entries.at(i).isTypedIn ? CompletionEntry::TypedInHistoryType : CompletionEntry::HistoryType)));
 		}
 	}
 
@@ -178,7 +180,7 @@ void AddressCompletionModel::updateModel()
 
 		for (int i = 0; i < entries.count(); ++i)
 		{
-			completions.append(CompletionEntry(entries.at(i).entry->getUrl(), entries.at(i).entry->getTitle(), entries.at(i).match, entries.at(i).entry->getIcon(), entries.at(i).entry->getTimeVisited(), CompletionEntry::TypedInHistoryType, entries.at(i).entry->getIdentifier()));
+			completions.append(CompletionEntry(entries.at(i).entry.url, entries.at(i).entry.getTitle(), entries.at(i).match, {}, entries.at(i).entry.timeVisited, CompletionEntry::TypedInHistoryType, entries.at(i).entry.identifier));
 		}
 	}
 
@@ -214,6 +216,14 @@ void AddressCompletionModel::updateModel()
 	endResetModel();
 }
 
+void AddressCompletionModel::handleIconChanged()
+{
+	if (!m_completions.isEmpty())
+	{
+		emit dataChanged(index(0, 0), index((m_completions.count() - 1), 0), {Qt::DecorationRole});
+	}
+}
+
 void AddressCompletionModel::setFilter(const QString &filter)
 {
 	m_filter = filter;
@@ -269,6 +279,19 @@ QVariant AddressCompletionModel::data(const QModelIndex &index, int role) const
 		switch (role)
 		{
 			case Qt::DecorationRole:
+				if (m_completions.at(index.row()).icon.isNull())
+				{
+					switch (m_completions.at(index.row()).type)
+					{
+						case CompletionEntry::BookmarkType:
+						case CompletionEntry::HistoryType:
+						case CompletionEntry::TypedInHistoryType:
+							return HistoryManager::getIcon(m_completions.at(index.row()).url);
+						default:
+							break;
+					}
+				}
+
 				return m_completions.at(index.row()).icon;
 			case HistoryIdentifierRole:
 				return (m_completions.at(index.row()).historyIdentifier);
@@ -107,6 +107,9 @@ protected:
 	void timerEvent(QTimerEvent *event) override;
 	void updateModel();
 
+protected slots:
+	void handleIconChanged();
+
 private:
 	QVector<CompletionEntry> m_completions;
 	QString m_filter;
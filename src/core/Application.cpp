@@ -22,6 +22,8 @@
 #include "AddonsManager.h"
 #include "BookmarksManager.h"
 #include "Console.h"
+#include "ContentFiltersManager.h"
+#include "FaviconsManager.h"
 #include "FeedsManager.h"
 #include "GesturesManager.h"
 #include "HandlersManager.h"
@@ -142,6 +144,7 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 	m_commandLineParser.addOption(QCommandLineOption(QLatin1String("new-private-window"), translate("main", "Loads URL in new private window")));
 	m_commandLineParser.addOption(QCommandLineOption(QLatin1String("readonly"), translate("main", "Tells application to avoid writing data to disk")));
 	m_commandLineParser.addOption(QCommandLineOption(QLatin1String("report"), translate("main", "Prints out diagnostic report and exits application")));
+	m_commandLineParser.addOption(QCommandLineOption(QLatin1String("profile-settings"), translate("main", "Collects statistics of settings access")));
 
 	QStringList arguments(Application::arguments());
 	QString argumentsPath(QDir::current().filePath(QLatin1String("arguments.txt")));
@@ -321,6 +324,7 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	Console::createInstance();
 
+	SettingsManager::setProfilingEnabled(m_commandLineParser.isSet(QLatin1String("profile-settings")));
 	SettingsManager::createInstance(profilePath);
 
 	if (!isReadOnly && !m_isFirstRun && !QFileInfo(profilePath).isWritable())
@@ -411,6 +415,8 @@ Application::Application(int &argc, char **argv) : QApplication(argc, argv),
 
 	ThemesManager::createInstance();
 
+	FaviconsManager::createInstance();
+
 	ActionsManager::createInstance();
 
 	AddonsManager::createInstance();
@@ -1448,7 +1454,7 @@ QString Application::createReport(ReportOptions options)
 		stream << QLatin1String("\n\t");
 		stream.setFieldWidth(20);
 		stream << QLatin1String("History");
-		stream << SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json"));
+		stream << SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.dat"));
 		stream.setFieldWidth(0);
 		stream << QLatin1String("\n\t");
 		stream.setFieldWidth(20);
@@ -1461,6 +1467,7 @@ QString Application::createReport(ReportOptions options)
 	if (options.testFlag(SettingsReport))
 	{
 		stream << SettingsManager::createReport();
+		stream << ContentFiltersManager::createReport();
 	}
 
 	if (options.testFlag(KeyboardShortcutsReport))
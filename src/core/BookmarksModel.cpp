@@ -20,6 +20,7 @@
 
 #include "BookmarksModel.h"
 #include "Console.h"
+#include "FaviconsManager.h"
 #include "FeedsManager.h"
 #include "HistoryManager.h"
 #include "SessionsManager.h"
@@ -360,6 +361,8 @@ BookmarksModel::BookmarksModel(const QString &path, FormatMode mode, QObject *pa
 	appendRow(m_trashItem);
 	setItemPrototype(new Bookmark());
 
+	connect(FaviconsManager::getInstance(), &FaviconsManager::iconChanged, this, &BookmarksModel::handleIconChanged);
+
 	if (!QFile::exists(path))
 	{
 		return;
@@ -867,6 +870,11 @@ void BookmarksModel::removeBookmarkUrl(Bookmark *bookmark)
 					if (m_urls[url].isEmpty())
 					{
 						m_urls.remove(url);
+
+						if (m_mode == BookmarksMode)
+						{
+							FaviconsManager::unpinIcon(url);
+						}
 					}
 				}
 			}
@@ -896,6 +904,11 @@ void BookmarksModel::readdBookmarkUrl(Bookmark *bookmark)
 					if (!m_urls.contains(url))
 					{
 						m_urls[url] = {};
+
+						if (m_mode == BookmarksMode)
+						{
+							FaviconsManager::pinIcon(url);
+						}
 					}
 
 					m_urls[url].append(bookmark);
@@ -1000,6 +1013,18 @@ void BookmarksModel::handleFeedModified(Feed *feed)
 	emit modelModified();
 }
 
+void BookmarksModel::handleIconChanged(const QUrl &url)
+{
+	const QVector<Bookmark*> bookmarks(getBookmarks(url));
+
+	for (int i = 0; i < bookmarks.count(); ++i)
+	{
+		const QModelIndex index(bookmarks.at(i)->index());
+
+		emit dataChanged(index, index, {Qt::DecorationRole});
+	}
+}
+
 void BookmarksModel::handleKeywordChanged(Bookmark *bookmark, const QString &newKeyword, const QString &oldKeyword)
 {
 	if (!oldKeyword.isEmpty() && m_keywords.contains(oldKeyword))
@@ -1022,6 +1047,11 @@ void BookmarksModel::handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, co
 		if (m_urls[oldUrl].isEmpty())
 		{
 			m_urls.remove(oldUrl);
+
+			if (m_mode == BookmarksMode)
+			{
+				FaviconsManager::unpinIcon(oldUrl);
+			}
 		}
 	}
 
@@ -1030,6 +1060,11 @@ void BookmarksModel::handleUrlChanged(Bookmark *bookmark, const QUrl &newUrl, co
 		if (!m_urls.contains(newUrl))
 		{
 			m_urls[newUrl] = {};
+
+			if (m_mode == BookmarksMode)
+			{
+				FaviconsManager::pinIcon(newUrl);
+			}
 		}
 
 		m_urls[newUrl].append(bookmark);
@@ -152,6 +152,7 @@ protected:
 
 protected slots:
 	void handleFeedModified(Feed *feed);
+	void handleIconChanged(const QUrl &url);
 	void notifyBookmarkModified(const QModelIndex &index);
 
 private:
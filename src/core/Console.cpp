@@ -20,14 +20,22 @@
 #include "Console.h"
 
 #include <QtCore/QCoreApplication>
+#include <QtCore/QMetaMethod>
+#include <QtCore/QTimerEvent>
 
 namespace Otter
 {
 
 Console* Console::m_instance(nullptr);
 QVector<Console::Message> Console::m_messages;
+QVector<Console::BlockedRequest> Console::m_blockedRequests;
+QMutex Console::m_blockedRequestsMutex;
+quint64 Console::m_blockedRequestsAmount(0);
+quint64 Console::m_notifiedBlockedRequestsAmount(0);
+bool Console::m_isNotificationScheduled(false);
 
-Console::Console(QObject *parent) : QObject(parent)
+Console::Console(QObject *parent) : QObject(parent),
+	m_notificationTimer(0)
 {
 }
 
@@ -39,6 +47,63 @@ void Console::createInstance()
 	}
 }
 
+void Console::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_notificationTimer)
+	{
+		return;
+	}
+
+	killTimer(m_notificationTimer);
+
+	m_notificationTimer = 0;
+
+	const bool isConnected(isSignalConnected(QMetaMethod::fromSignal(&Console::messagesAdded)));
+	QVector<BlockedRequest> requests;
+
+	{
+		QMutexLocker locker(&m_blockedRequestsMutex);
+
+		if (isConnected)
+		{
+			const quint64 amount(qMin((m_blockedRequestsAmount - m_notifiedBlockedRequestsAmount), static_cast<quint64>(m_blockedRequests.count())));
+
+			requests.reserve(static_cast<int>(amount));
+
+			for (quint64 i = (m_blockedRequestsAmount - amount); i < m_blockedRequestsAmount; ++i)
+			{
+				requests.append(m_blockedRequests.at(static_cast<int>(i % m_blockedRequestsLimit)));
+			}
+		}
+
+		m_notifiedBlockedRequestsAmount = m_blockedRequestsAmount;
+		m_isNotificationScheduled = false;
+	}
+
+	if (requests.isEmpty())
+	{
+		return;
+	}
+
+	QVector<Message> messages;
+	messages.reserve(requests.count());
+
+	for (int i = 0; i < requests.count(); ++i)
+	{
+		messages.append(createMessage(requests.at(i)));
+	}
+
+	emit messagesAdded(messages);
+}
+
+void Console::scheduleBlockedRequestsNotification()
+{
+	if (m_notificationTimer == 0)
+	{
+		m_notificationTimer = startTimer(m_notificationInterval);
+	}
+}
+
 void Console::addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source, int line, quint64 window)
 {
 	Message message;
@@ -59,14 +124,84 @@ void Console::addMessage(const QString &note, MessageCategory category, MessageL
 	emit m_instance->messageAdded(message);
 }
 
+void Console::addBlockedRequest(const QUrl &url, const QString &rule, const QString &profile, quint64 window)
+{
+	BlockedRequest request;
+	request.url = url;
+	request.rule = rule;
+	request.profile = profile;
+	request.time = QDateTime::currentMSecsSinceEpoch();
+	request.window = window;
+
+	QMutexLocker locker(&m_blockedRequestsMutex);
+
+	if (m_blockedRequests.count() < m_blockedRequestsLimit)
+	{
+		if (m_blockedRequests.isEmpty())
+		{
+			m_blockedRequests.reserve(m_blockedRequestsLimit);
+		}
+
+		m_blockedRequests.append(request);
+	}
+	else
+	{
+		m_blockedRequests[static_cast<int>(m_blockedRequestsAmount % m_blockedRequestsLimit)] = request;
+	}
+
+	++m_blockedRequestsAmount;
+
+	if (!m_isNotificationScheduled && m_instance)
+	{
+		m_isNotificationScheduled = true;
+
+		QMetaObject::invokeMethod(m_instance, "scheduleBlockedRequestsNotification", Qt::QueuedConnection);
+	}
+}
+
 Console* Console::getInstance()
 {
 	return m_instance;
 }
 
+Console::Message Console::createMessage(const BlockedRequest &request)
+{
+	Message message;
+	message.time = QDateTime::fromMSecsSinceEpoch(request.time, Qt::UTC);
+	message.note = request.rule;
+	message.source = request.url.toString();
+	message.profile = request.profile;
+	message.category = NetworkCategory;
+	message.level = LogLevel;
+	message.window = request.window;
+
+	return message;
+}
+
 QVector<Console::Message> Console::getMessages()
 {
-	return m_messages;
+	QVector<BlockedRequest> requests;
+
+	{
+		QMutexLocker locker(&m_blockedRequestsMutex);
+
+		requests.reserve(m_blockedRequests.count());
+
+		for (quint64 i = (m_blockedRequestsAmount - static_cast<quint64>(m_blockedRequests.count())); i < m_notifiedBlockedRequestsAmount; ++i)
+		{
+			requests.append(m_blockedRequests.at(static_cast<int>(i % m_blockedRequestsLimit)));
+		}
+	}
+
+	QVector<Message> messages(m_messages);
+	messages.reserve(messages.count() + requests.count());
+
+	for (int i = 0; i < requests.count(); ++i)
+	{
+		messages.append(createMessage(requests.at(i)));
+	}
+
+	return messages;
 }
 
 }
@@ -21,7 +21,9 @@
 #define OTTER_CONSOLE_H
 
 #include <QtCore/QDateTime>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
+#include <QtCore/QUrl>
 #include <QtCore/QVector>
 
 namespace Otter
@@ -56,6 +58,7 @@ public:
 		QDateTime time = QDateTime::currentDateTimeUtc();
 		QString note;
 		QString source;
+		QString profile;
 		MessageCategory category = OtherCategory;
 		MessageLevel level = UnknownLevel;
 		quint64 window = 0;
@@ -64,18 +67,44 @@ public:
 
 	static void createInstance();
 	static void addMessage(const QString &note, MessageCategory category, MessageLevel level, const QString &source = {}, int line = -1, quint64 window = 0);
+	static void addBlockedRequest(const QUrl &url, const QString &rule, const QString &profile, quint64 window = 0);
 	static Console* getInstance();
 	static QVector<Console::Message> getMessages();
 
 protected:
+	struct BlockedRequest final
+	{
+		QUrl url;
+		QString rule;
+		QString profile;
+		qint64 time = 0;
+		quint64 window = 0;
+	};
+
 	explicit Console(QObject *parent = nullptr);
 
+	void timerEvent(QTimerEvent *event) override;
+	static Message createMessage(const BlockedRequest &request);
+
+protected slots:
+	void scheduleBlockedRequestsNotification();
+
 private:
+	int m_notificationTimer;
+
 	static Console *m_instance;
 	static QVector<Message> m_messages;
+	static QVector<BlockedRequest> m_blockedRequests;
+	static QMutex m_blockedRequestsMutex;
+	static quint64 m_blockedRequestsAmount;
+	static quint64 m_notifiedBlockedRequestsAmount;
+	static bool m_isNotificationScheduled;
+	static const int m_blockedRequestsLimit = 1000;
+	static const int m_notificationInterval = 250;
 
 signals:
 	void messageAdded(const Console::Message &message);
+	void messagesAdded(const QVector<Console::Message> &messages);
 };
 
 }
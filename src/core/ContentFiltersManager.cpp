@@ -21,13 +21,23 @@
 #include "ContentFiltersManager.h"
 #include "AdblockContentFiltersProfile.h"
 #include "Console.h"
+#include "FraudCheckingContentFiltersProfile.h"
+#include "Job.h"
 #include "JsonSettings.h"
 #include "SettingsManager.h"
 #include "SessionsManager.h"
+#include "Utils.h"
 
+#include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
 #include <QtCore/QJsonArray>
 #include <QtCore/QJsonObject>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSet>
+#include <QtCore/QTextStream>
+#include <QtCore/QThread>
 #include <QtCore/QTimer>
 
 namespace Otter
@@ -36,10 +46,23 @@ namespace Otter
 ContentFiltersManager* ContentFiltersManager::m_instance(nullptr);
 QVector<ContentFiltersProfile*> ContentFiltersManager::m_contentBlockingProfiles;
 QVector<ContentFiltersProfile*> ContentFiltersManager::m_fraudCheckingProfiles;
+QVector<ContentFiltersProfile*> ContentFiltersManager::m_loadingProfiles;
+std::atomic<ContentFiltersManager::PendingRequestsPolicy> ContentFiltersManager::m_pendingRequestsPolicy(WaitPendingRequestsPolicy);
+QCache<QString, ContentFiltersManager::CheckResult> ContentFiltersManager::m_cache(m_cacheSize);
+QCache<QString, QString> ContentFiltersManager::m_styleSheetsCache(m_styleSheetsCacheSize);
+QCache<QString, ContentFiltersManager::CosmeticFiltersMode> ContentFiltersManager::m_cosmeticFiltersModesCache(m_cacheSize);
+QMutex ContentFiltersManager::m_cacheMutex;
+int ContentFiltersManager::m_loadingProfilesAmount(0);
+quint64 ContentFiltersManager::m_cacheHits(0);
+quint64 ContentFiltersManager::m_cacheMisses(0);
 
 ContentFiltersManager::ContentFiltersManager(QObject *parent) : QObject(parent),
 	m_saveTimer(0)
 {
+	handleOptionChanged(SettingsManager::ContentBlocking_PendingRequestsPolicyOption, SettingsManager::getOption(SettingsManager::ContentBlocking_PendingRequestsPolicyOption));
+
+	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &ContentFiltersManager::handleOptionChanged);
+
 	QTimer::singleShot(1000, this, [&]()
 	{
 		initialize();
@@ -171,13 +194,107 @@ void ContentFiltersManager::initialize()
 
 		connect(profile, &ContentFiltersProfile::profileModified, profile, [=]()
 		{
+			clearCache();
+
 			m_instance->scheduleSave();
 
 			emit m_instance->profileModified(profile->getName());
 		});
+		connect(profile, &ContentFiltersProfile::loadingFinished, m_instance, &ContentFiltersManager::handleProfileLoadingFinished);
 	}
 
 	m_contentBlockingProfiles.squeeze();
+
+	const QList<QFileInfo> existingFraudCheckingProfiles(QDir(SessionsManager::getWritableDataPath(QLatin1String("fraudChecking"))).entryInfoList({QLatin1String("*.txt")}, QDir::Files));
+	const QJsonObject localFraudCheckingObject(JsonSettings(SessionsManager::getWritableDataPath(QLatin1String("fraudChecking.json"))).object());
+	QStringList fraudCheckingProfiles(localFraudCheckingObject.keys());
+
+	for (int i = 0; i < existingFraudCheckingProfiles.count(); ++i)
+	{
+		const QString name(existingFraudCheckingProfiles.at(i).completeBaseName());
+
+		if (!fraudCheckingProfiles.contains(name))
+		{
+			fraudCheckingProfiles.append(name);
+		}
+	}
+
+	fraudCheckingProfiles.sort();
+
+	const bool isFraudCheckingEnabled(SettingsManager::getOption(SettingsManager::Security_EnableFraudCheckingOption).toBool());
+
+	for (int i = 0; i < fraudCheckingProfiles.count(); ++i)
+	{
+		const QJsonObject profileObject(localFraudCheckingObject.value(fraudCheckingProfiles.at(i)).toObject());
+
+		if (profileObject.value(QLatin1String("isHidden")).toBool())
+		{
+			continue;
+		}
+
+		ContentFiltersProfile::ProfileSummary profileSummary;
+		profileSummary.name = fraudCheckingProfiles.at(i);
+		profileSummary.title = profileObject.value(QLatin1String("title")).toString();
+		profileSummary.updateUrl = QUrl(profileObject.value(QLatin1String("updateUrl")).toString());
+		profileSummary.lastUpdate = QDateTime::fromString(profileObject.value(QLatin1String("lastUpdate")).toString(), Qt::ISODate);
+		profileSummary.lastUpdate.setTimeSpec(Qt::UTC);
+		profileSummary.updateInterval = profileObject.value(QLatin1String("updateInterval")).toInt();
+		profileSummary.cosmeticFiltersMode = NoFilters;
+
+		ContentFiltersProfile::ProfileFlags flags(ContentFiltersProfile::NoFlags);
+
+		if (!profileSummary.title.isEmpty())
+		{
+			flags |= ContentFiltersProfile::HasCustomTitleFlag;
+		}
+
+		ContentFiltersProfile *profile(new FraudCheckingContentFiltersProfile(profileSummary, flags, m_instance));
+
+		m_fraudCheckingProfiles.append(profile);
+
+		connect(profile, &ContentFiltersProfile::profileModified, m_instance, &ContentFiltersManager::scheduleSave);
+		connect(profile, &ContentFiltersProfile::loadingFinished, m_instance, &ContentFiltersManager::clearCache);
+
+		if (isFraudCheckingEnabled)
+		{
+			profile->load();
+		}
+	}
+
+	m_fraudCheckingProfiles.squeeze();
+
+	loadProfiles();
+}
+
+void ContentFiltersManager::loadProfiles()
+{
+	QStringList names(SettingsManager::getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList());
+	const QStringList hosts(SettingsManager::getOverrideHosts(SettingsManager::ContentBlocking_ProfilesOption));
+
+	for (int i = 0; i < hosts.count(); ++i)
+	{
+		names.append(SettingsManager::getOption(SettingsManager::ContentBlocking_ProfilesOption, hosts.at(i)).toStringList());
+	}
+
+	names.removeDuplicates();
+
+	m_loadingProfiles.clear();
+
+	for (int i = 0; i < m_contentBlockingProfiles.count(); ++i)
+	{
+		ContentFiltersProfile *profile(m_contentBlockingProfiles.at(i));
+
+		if (names.contains(profile->getName()) && !profile->isLoaded())
+		{
+			m_loadingProfiles.append(profile);
+
+			profile->load();
+		}
+	}
+
+	m_loadingProfilesAmount = m_loadingProfiles.count();
+
+	emit m_instance->loadingProgressChanged(getLoadingProgress());
 }
 
 void ContentFiltersManager::timerEvent(QTimerEvent *event)
@@ -261,6 +378,45 @@ void ContentFiltersManager::timerEvent(QTimerEvent *event)
 
 		settings.setObject(mainObject);
 		settings.save();
+
+		if (m_fraudCheckingProfiles.isEmpty())
+		{
+			return;
+		}
+
+		JsonSettings fraudCheckingSettings(SessionsManager::getWritableDataPath(QLatin1String("fraudChecking.json")));
+		QJsonObject fraudCheckingObject;
+
+		for (int i = 0; i < m_fraudCheckingProfiles.count(); ++i)
+		{
+			const ContentFiltersProfile *profile(m_fraudCheckingProfiles.at(i));
+			QJsonObject profileObject;
+			const int updateInterval(profile->getUpdateInterval());
+
+			if (updateInterval > 0)
+			{
+				profileObject.insert(QLatin1String("updateInterval"), updateInterval);
+			}
+
+			const QDateTime lastUpdate(profile->getLastUpdate());
+
+			if (lastUpdate.isValid())
+			{
+				profileObject.insert(QLatin1String("lastUpdate"), lastUpdate.toString(Qt::ISODate));
+			}
+
+			if (profile->getFlags().testFlag(ContentFiltersProfile::HasCustomTitleFlag))
+			{
+				profileObject.insert(QLatin1String("title"), profile->getTitle());
+			}
+
+			profileObject.insert(QLatin1String("updateUrl"), profile->getUpdateUrl().url());
+
+			fraudCheckingObject.insert(profile->getName(), profileObject);
+		}
+
+		fraudCheckingSettings.setObject(fraudCheckingObject);
+		fraudCheckingSettings.save();
 	}
 }
 
@@ -272,6 +428,62 @@ void ContentFiltersManager::scheduleSave()
 	}
 }
 
+void ContentFiltersManager::handleOptionChanged(int identifier, const QVariant &value)
+{
+	switch (identifier)
+	{
+		case SettingsManager::ContentBlocking_PendingRequestsPolicyOption:
+			{
+				const QString policyValue(value.toString());
+
+				if (policyValue == QLatin1String("allow"))
+				{
+					m_pendingRequestsPolicy.store(AllowPendingRequestsPolicy, std::memory_order_relaxed);
+				}
+				else if (policyValue == QLatin1String("block"))
+				{
+					m_pendingRequestsPolicy.store(BlockPendingRequestsPolicy, std::memory_order_relaxed);
+				}
+				else
+				{
+					m_pendingRequestsPolicy.store(WaitPendingRequestsPolicy, std::memory_order_relaxed);
+				}
+			}
+
+			break;
+		case SettingsManager::ContentBlocking_IgnoreHostsOption:
+			clearCache();
+
+			break;
+		case SettingsManager::ContentBlocking_ProfilesOption:
+			if (!m_contentBlockingProfiles.isEmpty())
+			{
+				loadProfiles();
+			}
+
+			break;
+		default:
+			break;
+	}
+}
+
+void ContentFiltersManager::handleProfileLoadingFinished()
+{
+	ContentFiltersProfile *profile(qobject_cast<ContentFiltersProfile*>(sender()));
+
+	clearCache();
+
+	if (profile && m_loadingProfiles.removeAll(profile) > 0)
+	{
+		emit loadingProgressChanged(getLoadingProgress());
+
+		if (m_loadingProfiles.isEmpty())
+		{
+			Console::addMessage(QCoreApplication::translate("main", "Loaded %n content blocking profile(s)", "", m_loadingProfilesAmount), Console::ContentFiltersCategory, Console::LogLevel);
+		}
+	}
+}
+
 void ContentFiltersManager::addProfile(ContentFiltersProfile *profile)
 {
 	if (!profile)
@@ -299,11 +511,15 @@ void ContentFiltersManager::addProfile(ContentFiltersProfile *profile)
 		m_contentBlockingProfiles.append(profile);
 	}
 
+	clearCache();
+
 	m_instance->scheduleSave();
 
 	emit m_instance->profileAdded(profile->getName());
 
 	connect(profile, &ContentFiltersProfile::profileModified, m_instance, &ContentFiltersManager::scheduleSave);
+	connect(profile, &ContentFiltersProfile::profileModified, m_instance, &ContentFiltersManager::clearCache);
+	connect(profile, &ContentFiltersProfile::loadingFinished, m_instance, &ContentFiltersManager::handleProfileLoadingFinished);
 }
 
 void ContentFiltersManager::removeProfile(ContentFiltersProfile *profile, bool removeFile)
@@ -337,11 +553,34 @@ void ContentFiltersManager::removeProfile(ContentFiltersProfile *profile, bool r
 
 	m_contentBlockingProfiles.removeAll(profile);
 
+	clearCache();
+
+	if (m_loadingProfiles.removeAll(profile) > 0)
+	{
+		emit m_instance->loadingProgressChanged(getLoadingProgress());
+	}
+
 	profile->deleteLater();
 
 	emit m_instance->profileRemoved(name);
 }
 
+void ContentFiltersManager::clearCache()
+{
+	QMutexLocker locker(&m_cacheMutex);
+
+	m_cache.clear();
+	m_styleSheetsCache.clear();
+	m_cosmeticFiltersModesCache.clear();
+
+	locker.unlock();
+
+	if (m_instance)
+	{
+		emit m_instance->cacheCleared();
+	}
+}
+
 ContentFiltersManager* ContentFiltersManager::getInstance()
 {
 	return m_instance;
@@ -397,14 +636,80 @@ ContentFiltersManager::CheckResult ContentFiltersManager::checkUrl(const QVector
 		return {};
 	}
 
+	QString cacheKey;
+	cacheKey.reserve(requestUrl.url().length() + 64);
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		cacheKey.append(QString::number(profiles.at(i)) + QLatin1Char(','));
+	}
+
+	cacheKey.append(QLatin1Char(' ') + baseUrl.host() + QLatin1Char(' ') + QString::number(resourceType) + QLatin1Char(' ') + requestUrl.url());
+
+	{
+		QMutexLocker locker(&m_cacheMutex);
+		const CheckResult *cachedResult(m_cache.object(cacheKey));
+
+		if (cachedResult)
+		{
+			++m_cacheHits;
+
+			return *cachedResult;
+		}
+
+		++m_cacheMisses;
+	}
+
 	CheckResult result;
 	result.isFraud = ((resourceType == NetworkManager::MainFrameType || resourceType == NetworkManager::SubFrameType) ? isFraud(requestUrl) : false);
 
+	QVector<AdblockContentFiltersProfile*> adblockProfiles;
+	QVector<int> adblockIdentifiers;
+	const PendingRequestsPolicy pendingRequestsPolicy(m_pendingRequestsPolicy.load(std::memory_order_relaxed));
+	const bool canWait(pendingRequestsPolicy == WaitPendingRequestsPolicy && QThread::currentThread() != QCoreApplication::instance()->thread());
+	QElapsedTimer waitTimer;
+	bool isCacheable(true);
+
 	for (int i = 0; i < profiles.count(); ++i)
 	{
 		if (profiles.at(i) >= 0 && profiles.at(i) < m_contentBlockingProfiles.count())
 		{
-			CheckResult currentResult(m_contentBlockingProfiles.at(profiles.at(i))->checkUrl(baseUrl, requestUrl, resourceType));
+			ContentFiltersProfile *profile(m_contentBlockingProfiles.at(profiles.at(i)));
+
+			if (!profile->isLoaded())
+			{
+				profile->load();
+
+				if (canWait && !waitTimer.isValid())
+				{
+					waitTimer.start();
+				}
+
+				if (!canWait || !profile->waitForLoaded(qMax(0, static_cast<int>(m_pendingRequestsTimeout - waitTimer.elapsed()))))
+				{
+					isCacheable = false;
+
+					if (pendingRequestsPolicy == BlockPendingRequestsPolicy)
+					{
+						result.profile = profiles.at(i);
+						result.isBlocked = true;
+					}
+
+					continue;
+				}
+			}
+
+			AdblockContentFiltersProfile *adblockProfile(qobject_cast<AdblockContentFiltersProfile*>(profile));
+
+			if (adblockProfile)
+			{
+				adblockProfiles.append(adblockProfile);
+				adblockIdentifiers.append(profiles.at(i));
+
+				continue;
+			}
+
+			CheckResult currentResult(profile->checkUrl(baseUrl, requestUrl, resourceType));
 			currentResult.profile = profiles.at(i);
 			currentResult.isFraud = result.isFraud;
 
@@ -414,11 +719,33 @@ ContentFiltersManager::CheckResult ContentFiltersManager::checkUrl(const QVector
 			}
 			else if (currentResult.isException)
 			{
-				return currentResult;
+				result = currentResult;
+
+				break;
 			}
 		}
 	}
 
+	if (!result.isException && !adblockProfiles.isEmpty())
+	{
+		CheckResult currentResult(AdblockContentFiltersProfile::checkUrl(adblockProfiles, baseUrl, requestUrl, resourceType));
+
+		if (currentResult.isBlocked || currentResult.isException)
+		{
+			currentResult.profile = adblockIdentifiers.at(currentResult.profile);
+			currentResult.isFraud = result.isFraud;
+
+			result = currentResult;
+		}
+	}
+
+	if (isCacheable)
+	{
+		QMutexLocker locker(&m_cacheMutex);
+
+		m_cache.insert(cacheKey, new CheckResult(result));
+	}
+
 	return result;
 }
 
@@ -429,7 +756,7 @@ ContentFiltersManager::CosmeticFiltersResult ContentFiltersManager::getCosmeticF
 		return {};
 	}
 
-	const CosmeticFiltersMode mode(checkUrl(profiles, requestUrl, requestUrl, NetworkManager::OtherType).comesticFiltersMode);
+	const CosmeticFiltersMode mode(getCosmeticFiltersMode(profiles, requestUrl));
 
 	if (mode == NoFilters)
 	{
@@ -533,8 +860,600 @@ bool ContentFiltersManager::isFraud(const QUrl &url)
 	return false;
 }
 
-ContentFiltersProfile::ContentFiltersProfile(QObject *parent) : QObject(parent)
+QString ContentFiltersManager::createReport()
+{
+	const CacheStatistics statistics(getCacheStatistics());
+	QString report;
+	QTextStream stream(&report);
+	stream.setFieldAlignment(QTextStream::AlignLeft);
+	stream << QLatin1String("Content Blocking:\n\t");
+	stream.setFieldWidth(20);
+	stream << QLatin1String("Cache Size");
+	stream << statistics.size;
+	stream.setFieldWidth(0);
+	stream << QLatin1String("\n\t");
+	stream.setFieldWidth(20);
+	stream << QLatin1String("Cache Hits");
+	stream << statistics.hits;
+	stream.setFieldWidth(0);
+	stream << QLatin1String("\n\t");
+	stream.setFieldWidth(20);
+	stream << QLatin1String("Cache Misses");
+	stream << statistics.misses;
+	stream.setFieldWidth(0);
+	stream << QLatin1String("\n\t");
+	stream.setFieldWidth(20);
+	stream << QLatin1String("Loading Progress");
+	stream << (QString::number(getLoadingProgress()) + QLatin1Char('%'));
+	stream.setFieldWidth(0);
+	stream << QLatin1String("\n\n");
+	stream << QLatin1String("Content Blocking Memory Usage:\n");
+
+	for (int i = 0; i < m_contentBlockingProfiles.count(); ++i)
+	{
+		const ContentFiltersProfile *profile(m_contentBlockingProfiles.at(i));
+
+		if (!profile->isLoaded())
+		{
+			continue;
+		}
+
+		stream << QLatin1Char('\t');
+		stream.setFieldWidth(30);
+		stream << profile->getName();
+		stream << Utils::formatUnit(static_cast<qint64>(profile->getMemoryUsage()), false, 1, true);
+		stream.setFieldWidth(0);
+		stream << QLatin1Char('\n');
+	}
+
+	stream << QLatin1String("\nFraud Checking Memory Usage:\n");
+
+	for (int i = 0; i < m_fraudCheckingProfiles.count(); ++i)
+	{
+		const ContentFiltersProfile *profile(m_fraudCheckingProfiles.at(i));
+
+		if (!profile->isLoaded())
+		{
+			continue;
+		}
+
+		stream << QLatin1Char('\t');
+		stream.setFieldWidth(30);
+		stream << profile->getName();
+		stream << Utils::formatUnit(static_cast<qint64>(profile->getMemoryUsage()), false, 1, true);
+		stream.setFieldWidth(0);
+		stream << QLatin1Char('\n');
+	}
+
+	stream << QLatin1Char('\n');
+
+	return report;
+}
+
+QString ContentFiltersManager::getCosmeticFiltersStyleSheet(const QVector<int> &profiles, const QUrl &requestUrl)
+{
+	if (profiles.isEmpty() || requestUrl.host().isEmpty())
+	{
+		return {};
+	}
+
+	const CosmeticFiltersMode mode(getCosmeticFiltersMode(profiles, requestUrl));
+
+	if (mode == NoFilters)
+	{
+		return {};
+	}
+
+	QStringList keyParts;
+	keyParts.reserve(profiles.count() + 2);
+	keyParts.append(QString::number(mode));
+	keyParts.append(requestUrl.host());
+
+	bool areProfilesLoaded(true);
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		const int index(profiles.at(i));
+
+		keyParts.append(QString::number(index));
+
+		if (index >= 0 && index < m_contentBlockingProfiles.count() && !m_contentBlockingProfiles.at(index)->isLoaded())
+		{
+			areProfilesLoaded = false;
+		}
+	}
+
+	const QString cacheKey(keyParts.join(QLatin1Char(' ')));
+
+	if (areProfilesLoaded)
+	{
+		QMutexLocker locker(&m_cacheMutex);
+		const QString *cachedStyleSheet(m_styleSheetsCache.object(cacheKey));
+
+		if (cachedStyleSheet)
+		{
+			return *cachedStyleSheet;
+		}
+	}
+
+	const QString styleSheet(createStyleSheet(getCosmeticFilters(profiles, requestUrl)));
+
+	if (areProfilesLoaded)
+	{
+		QMutexLocker locker(&m_cacheMutex);
+
+		m_styleSheetsCache.insert(cacheKey, new QString(styleSheet), qMax(1, ((styleSheet.size() * static_cast<int>(sizeof(QChar))) / 1024)));
+	}
+
+	return styleSheet;
+}
+
+QString ContentFiltersManager::getCosmeticFiltersStyleSheet(const QVector<int> &profiles, const QUrl &requestUrl, const QStringList &identifiers, const QStringList &classes)
+{
+	if (profiles.isEmpty() || (identifiers.isEmpty() && classes.isEmpty()) || getCosmeticFiltersMode(profiles, requestUrl) != AllFilters)
+	{
+		return {};
+	}
+
+	CosmeticFiltersResult result;
+	const QStringList domains(createSubdomainList(requestUrl.host()));
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		const int index(profiles.at(i));
+
+		if (index >= 0 && index < m_contentBlockingProfiles.count())
+		{
+			const CosmeticFiltersResult profileResult(m_contentBlockingProfiles.at(index)->getCosmeticFilters(domains, identifiers, classes));
+
+			result.rules.append(profileResult.rules);
+			result.exceptions.append(profileResult.exceptions);
+		}
+	}
+
+	return createStyleSheet(result);
+}
+
+QString ContentFiltersManager::createStyleSheet(const CosmeticFiltersResult &cosmeticFilters)
+{
+	QSet<QString> excludedSelectors;
+	excludedSelectors.reserve(cosmeticFilters.rules.count() + cosmeticFilters.exceptions.count());
+
+	for (int i = 0; i < cosmeticFilters.exceptions.count(); ++i)
+	{
+		excludedSelectors.insert(cosmeticFilters.exceptions.at(i));
+	}
+
+	QString styleSheet;
+
+	for (int i = 0; i < cosmeticFilters.rules.count(); ++i)
+	{
+		const QString &selector(cosmeticFilters.rules.at(i));
+
+		if (!excludedSelectors.contains(selector))
+		{
+			excludedSelectors.insert(selector);
+
+			styleSheet.append(selector);
+			styleSheet.append(QLatin1String(" {display:none !important;}\n"));
+		}
+	}
+
+	return styleSheet;
+}
+
+ContentFiltersManager::CosmeticFiltersMode ContentFiltersManager::getCosmeticFiltersMode(const QVector<int> &profiles, const QUrl &requestUrl)
+{
+	QString cacheKey;
+	bool areProfilesLoaded(true);
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		const int index(profiles.at(i));
+
+		cacheKey.append(QString::number(index) + QLatin1Char(','));
+
+		if (index >= 0 && index < m_contentBlockingProfiles.count() && !m_contentBlockingProfiles.at(index)->isLoaded())
+		{
+			areProfilesLoaded = false;
+		}
+	}
+
+	cacheKey.append(QLatin1Char(' ') + requestUrl.host());
+
+	if (areProfilesLoaded)
+	{
+		QMutexLocker locker(&m_cacheMutex);
+		const CosmeticFiltersMode *cachedMode(m_cosmeticFiltersModesCache.object(cacheKey));
+
+		if (cachedMode)
+		{
+			return *cachedMode;
+		}
+	}
+
+	const QUrl hostUrl(requestUrl.scheme() + QLatin1String("://") + requestUrl.host() + QLatin1Char('/'));
+	const CosmeticFiltersMode mode(checkUrl(profiles, hostUrl, hostUrl, NetworkManager::OtherType).comesticFiltersMode);
+
+	if (areProfilesLoaded)
+	{
+		QMutexLocker locker(&m_cacheMutex);
+
+		m_cosmeticFiltersModesCache.insert(cacheKey, new CosmeticFiltersMode(mode));
+	}
+
+	return mode;
+}
+
+ContentFiltersManager::CacheStatistics ContentFiltersManager::getCacheStatistics()
+{
+	QMutexLocker locker(&m_cacheMutex);
+	CacheStatistics statistics;
+	statistics.hits = m_cacheHits;
+	statistics.misses = m_cacheMisses;
+	statistics.size = m_cache.size();
+
+	return statistics;
+}
+
+int ContentFiltersManager::getLoadingProgress()
+{
+	if (m_loadingProfilesAmount == 0)
+	{
+		return 100;
+	}
+
+	return ((100 * (m_loadingProfilesAmount - m_loadingProfiles.count())) / m_loadingProfilesAmount);
+}
+
+ContentFiltersProfile::ContentFiltersProfile(const ContentFiltersProfile::ProfileSummary &profileSummary, ContentFiltersProfile::ProfileFlags flags, QObject *parent) : QObject(parent),
+	m_dataFetchJob(nullptr),
+	m_profileSummary(profileSummary),
+	m_error(NoError),
+	m_flags(flags),
+	m_generation(0),
+	m_isLoading(false)
+{
+}
+
+void ContentFiltersProfile::clear()
+{
+	QMutexLocker locker(&m_mutex);
+
+	++m_generation;
+
+	m_isLoading = false;
+
+	clearSnapshot();
+
+	m_loadingCondition.wakeAll();
+}
+
+void ContentFiltersProfile::load()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+
+		if (m_isLoading || isLoaded())
+		{
+			return;
+		}
+
+		m_isLoading = true;
+	}
+
+	if (thread() == QThread::currentThread())
+	{
+		loadData(false);
+	}
+	else
+	{
+		QMetaObject::invokeMethod(this, "loadData", Qt::QueuedConnection, Q_ARG(bool, false));
+	}
+}
+
+void ContentFiltersProfile::cancelLoading()
+{
+	clear();
+
+	m_loadingFutures.waitForFinished();
+}
+
+void ContentFiltersProfile::finishLoading()
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (!m_isLoading)
+	{
+		return;
+	}
+
+	m_isLoading = false;
+
+	m_loadingCondition.wakeAll();
+
+	locker.unlock();
+
+	emit loadingFinished(false);
+}
+
+void ContentFiltersProfile::finishLoading(quint64 generation, const std::function<void()> &setSnapshot)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (generation != m_generation)
+	{
+		return;
+	}
+
+	setSnapshot();
+
+	m_isLoading = false;
+
+	m_loadingCondition.wakeAll();
+
+	locker.unlock();
+
+	emit loadingFinished(true);
+}
+
+void ContentFiltersProfile::raiseError(const QString &message, ProfileError error)
+{
+	m_error = error;
+
+	Console::addMessage(message, Console::OtherCategory, Console::ErrorLevel, getPath());
+
+	emit profileModified();
+}
+
+void ContentFiltersProfile::resetError()
+{
+	m_error = NoError;
+}
+
+void ContentFiltersProfile::handleJobFinished(bool isSuccess)
+{
+	if (!m_dataFetchJob)
+	{
+		return;
+	}
+
+	QIODevice *device(m_dataFetchJob->getData());
+
+	m_dataFetchJob->deleteLater();
+	m_dataFetchJob = nullptr;
+
+	if (!isSuccess)
+	{
+		finishLoading();
+		raiseError(QCoreApplication::translate("main", "Failed to update profile %1: %2").arg(getTitle(), (device ? device->errorString() : tr("Download failure"))), DownloadError);
+
+		return;
+	}
+
+	const QByteArray data(device->readAll());
+
+	if (!validateData(data))
+	{
+		finishLoading();
+
+		return;
+	}
+
+	QDir().mkpath(QFileInfo(getPath()).absolutePath());
+
+	QSaveFile file(getPath());
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		finishLoading();
+		raiseError(QCoreApplication::translate("main", "Failed to update profile %1: %2").arg(getTitle(), file.errorString()), DownloadError);
+
+		return;
+	}
+
+	file.write(data);
+
+	m_profileSummary.lastUpdate = QDateTime::currentDateTimeUtc();
+
+	if (!file.commit())
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to update profile %1: %2").arg(getTitle(), file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+	}
+
+	if (isLoaded() || isLoading())
+	{
+		loadData(true);
+	}
+
+	emit profileModified();
+}
+
+void ContentFiltersProfile::setProfileSummary(const ContentFiltersProfile::ProfileSummary &profileSummary)
+{
+	const bool needsReload(profileSummary.cosmeticFiltersMode != m_profileSummary.cosmeticFiltersMode || profileSummary.areWildcardsEnabled != m_profileSummary.areWildcardsEnabled);
+
+	if (profileSummary.title != m_profileSummary.title)
+	{
+		m_flags |= HasCustomTitleFlag;
+	}
+	else if (!needsReload && profileSummary.updateUrl == m_profileSummary.updateUrl && profileSummary.updateInterval == m_profileSummary.updateInterval && profileSummary.category == m_profileSummary.category)
+	{
+		return;
+	}
+
+	m_profileSummary = profileSummary;
+
+	if (needsReload && (isLoaded() || isLoading()))
+	{
+		loadData(false);
+	}
+
+	emit profileModified();
+}
+
+void ContentFiltersProfile::setDefaultTitle(const QString &title)
+{
+	if (!m_flags.testFlag(HasCustomTitleFlag) && !title.isEmpty())
+	{
+		m_profileSummary.title = title;
+	}
+}
+
+void ContentFiltersProfile::addLoadingFuture(const QFuture<void> &future)
+{
+	m_loadingFutures.addFuture(future);
+}
+
+QString ContentFiltersProfile::getName() const
+{
+	return m_profileSummary.name;
+}
+
+QString ContentFiltersProfile::getTitle() const
+{
+	return (m_profileSummary.title.isEmpty() ? tr("(Unknown)") : m_profileSummary.title);
+}
+
+QUrl ContentFiltersProfile::getUpdateUrl() const
+{
+	return m_profileSummary.updateUrl;
+}
+
+QDateTime ContentFiltersProfile::getLastUpdate() const
+{
+	return m_profileSummary.lastUpdate;
+}
+
+ContentFiltersProfile::ProfileSummary ContentFiltersProfile::getProfileSummary() const
+{
+	return m_profileSummary;
+}
+
+ContentFiltersProfile::ProfileCategory ContentFiltersProfile::getCategory() const
+{
+	return m_profileSummary.category;
+}
+
+ContentFiltersProfile::ProfileError ContentFiltersProfile::getError() const
+{
+	return m_error;
+}
+
+ContentFiltersProfile::ProfileFlags ContentFiltersProfile::getFlags() const
 {
+	return m_flags;
+}
+
+int ContentFiltersProfile::getUpdateInterval() const
+{
+	return m_profileSummary.updateInterval;
+}
+
+int ContentFiltersProfile::getUpdateProgress() const
+{
+	return (m_dataFetchJob ? m_dataFetchJob->getProgress() : -1);
+}
+
+quint64 ContentFiltersProfile::startLoading()
+{
+	QMutexLocker locker(&m_mutex);
+
+	++m_generation;
+
+	m_isLoading = true;
+
+	return m_generation;
+}
+
+bool ContentFiltersProfile::update(const QUrl &url)
+{
+	if (m_dataFetchJob || thread() != QThread::currentThread())
+	{
+		return false;
+	}
+
+	const QUrl updateUrl(url.isValid() ? url : m_profileSummary.updateUrl);
+
+	if (!updateUrl.isValid())
+	{
+		if (updateUrl.isEmpty())
+		{
+			raiseError(QCoreApplication::translate("main", "Failed to update profile %1, update URL is empty").arg(getTitle()), DownloadError);
+		}
+		else
+		{
+			raiseError(QCoreApplication::translate("main", "Failed to update profile %1, update URL (%2) is invalid").arg(getTitle(), updateUrl.toString()), DownloadError);
+		}
+
+		return false;
+	}
+
+	m_dataFetchJob = new DataFetchJob(updateUrl, this);
+
+	connect(m_dataFetchJob, &Job::jobFinished, this, &ContentFiltersProfile::handleJobFinished);
+	connect(m_dataFetchJob, &Job::progressChanged, this, &ContentFiltersProfile::updateProgressChanged);
+
+	m_dataFetchJob->start();
+
+	emit profileModified();
+
+	return true;
+}
+
+bool ContentFiltersProfile::remove()
+{
+	const QString path(getPath());
+
+	if (m_dataFetchJob)
+	{
+		m_dataFetchJob->cancel();
+		m_dataFetchJob->deleteLater();
+		m_dataFetchJob = nullptr;
+	}
+
+	if (QFile::exists(path))
+	{
+		return QFile::remove(path);
+	}
+
+	return true;
+}
+
+bool ContentFiltersProfile::validateData(const QByteArray &data)
+{
+	Q_UNUSED(data)
+
+	return true;
+}
+
+bool ContentFiltersProfile::isLoading() const
+{
+	QMutexLocker locker(&m_mutex);
+
+	return m_isLoading;
+}
+
+bool ContentFiltersProfile::isUpdating() const
+{
+	return (m_dataFetchJob != nullptr);
+}
+
+bool ContentFiltersProfile::needsUpdate() const
+{
+	return (!m_dataFetchJob && m_profileSummary.updateInterval > 0 && (!m_profileSummary.lastUpdate.isValid() || m_profileSummary.lastUpdate.daysTo(QDateTime::currentDateTimeUtc()) > m_profileSummary.updateInterval));
+}
+
+bool ContentFiltersProfile::waitForLoaded(int timeout)
+{
+	QMutexLocker locker(&m_mutex);
+
+	if (m_isLoading && !isLoaded())
+	{
+		m_loadingCondition.wait(&m_mutex, static_cast<unsigned long>(timeout));
+	}
+
+	return isLoaded();
 }
 
 }
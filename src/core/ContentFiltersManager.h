@@ -23,12 +23,20 @@
 
 #include "NetworkManager.h"
 
+#include <QtCore/QCache>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QMutex>
 #include <QtCore/QUrl>
+#include <QtCore/QWaitCondition>
+
+#include <atomic>
+#include <functional>
 
 namespace Otter
 {
 
 class ContentFiltersProfile;
+class DataFetchJob;
 
 class ContentFiltersManager final : public QObject
 {
@@ -42,6 +50,13 @@ public:
 		AllFilters
 	};
 
+	enum PendingRequestsPolicy
+	{
+		AllowPendingRequestsPolicy = 0,
+		WaitPendingRequestsPolicy,
+		BlockPendingRequestsPolicy
+	};
+
 	struct CheckResult final
 	{
 		QString rule;
@@ -58,10 +73,19 @@ public:
 		QStringList exceptions;
 	};
 
+	struct CacheStatistics final
+	{
+		quint64 hits = 0;
+		quint64 misses = 0;
+		int size = 0;
+	};
+
 	static void createInstance();
 	static void initialize();
+	static void loadProfiles();
 	static void addProfile(ContentFiltersProfile *profile);
 	static void removeProfile(ContentFiltersProfile *profile, bool removeFile = false);
+	static void clearCache();
 	static ContentFiltersManager* getInstance();
 	static ContentFiltersProfile* getProfile(const QString &profile);
 	static ContentFiltersProfile* getProfile(const QUrl &url);
@@ -69,19 +93,28 @@ public:
 	static CheckResult checkUrl(const QVector<int> &profiles, const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType);
 	static CosmeticFiltersResult getCosmeticFilters(const QVector<int> &profiles, const QUrl &requestUrl);
 	static QStringList createSubdomainList(const QString &domain);
+	static QString createReport();
+	static QString getCosmeticFiltersStyleSheet(const QVector<int> &profiles, const QUrl &requestUrl);
+	static QString getCosmeticFiltersStyleSheet(const QVector<int> &profiles, const QUrl &requestUrl, const QStringList &identifiers, const QStringList &classes);
 	static QStringList getProfileNames();
 	static QVector<ContentFiltersProfile*> getContentBlockingProfiles();
 	static QVector<ContentFiltersProfile*> getFraudCheckingProfiles();
 	static QVector<int> getProfileIdentifiers(const QStringList &names);
+	static CacheStatistics getCacheStatistics();
+	static int getLoadingProgress();
 	static bool isFraud(const QUrl &url);
 
 protected:
 	explicit ContentFiltersManager(QObject *parent);
 
 	void timerEvent(QTimerEvent *event) override;
+	static QString createStyleSheet(const CosmeticFiltersResult &cosmeticFilters);
+	static CosmeticFiltersMode getCosmeticFiltersMode(const QVector<int> &profiles, const QUrl &requestUrl);
 
 protected slots:
 	void scheduleSave();
+	void handleOptionChanged(int identifier, const QVariant &value);
+	void handleProfileLoadingFinished();
 
 private:
 	int m_saveTimer;
@@ -89,11 +122,25 @@ private:
 	static ContentFiltersManager *m_instance;
 	static QVector<ContentFiltersProfile*> m_contentBlockingProfiles;
 	static QVector<ContentFiltersProfile*> m_fraudCheckingProfiles;
+	static QVector<ContentFiltersProfile*> m_loadingProfiles;
+	static std::atomic<PendingRequestsPolicy> m_pendingRequestsPolicy;
+	static QCache<QString, CheckResult> m_cache;
+	static QCache<QString, QString> m_styleSheetsCache;
+	static QCache<QString, CosmeticFiltersMode> m_cosmeticFiltersModesCache;
+	static QMutex m_cacheMutex;
+	static int m_loadingProfilesAmount;
+	static quint64 m_cacheHits;
+	static quint64 m_cacheMisses;
+	static const int m_pendingRequestsTimeout = 500;
+	static const int m_cacheSize = 2000;
+	static const int m_styleSheetsCacheSize = 32768;
 
 signals:
 	void profileAdded(const QString &profile);
 	void profileModified(const QString &profile);
 	void profileRemoved(const QString &profile);
+	void loadingProgressChanged(int progress);
+	void cacheCleared();
 };
 
 class ContentFiltersProfile : public QObject
@@ -139,34 +186,69 @@ public:
 		bool areWildcardsEnabled = false;
 	};
 
-	explicit ContentFiltersProfile(QObject *parent = nullptr);
+	explicit ContentFiltersProfile(const ProfileSummary &profileSummary, ProfileFlags flags, QObject *parent = nullptr);
 
-	virtual void clear() = 0;
-	virtual void setProfileSummary(const ProfileSummary &profileSummary) = 0;
-	virtual QString getName() const = 0;
-	virtual QString getTitle() const = 0;
+	void clear();
+	void load();
+	void setProfileSummary(const ProfileSummary &profileSummary);
+	QString getName() const;
+	QString getTitle() const;
 	virtual QString getPath() const = 0;
-	virtual QUrl getUpdateUrl() const = 0;
-	virtual QDateTime getLastUpdate() const = 0;
-	virtual ProfileSummary getProfileSummary() const = 0;
+	QUrl getUpdateUrl() const;
+	QDateTime getLastUpdate() const;
+	ProfileSummary getProfileSummary() const;
 	virtual ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) = 0;
 	virtual ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, bool isDomainOnly) = 0;
+	virtual ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, const QStringList &identifiers, const QStringList &classes) = 0;
 	virtual QVector<QLocale::Language> getLanguages() const = 0;
-	virtual ProfileCategory getCategory() const = 0;
+	ProfileCategory getCategory() const;
 	virtual ContentFiltersManager::CosmeticFiltersMode getCosmeticFiltersMode() const = 0;
-	virtual ProfileError getError() const = 0;
-	virtual ProfileFlags getFlags() const = 0;
-	virtual int getUpdateInterval() const = 0;
-	virtual int getUpdateProgress() const = 0;
-	virtual bool update(const QUrl &url = {}) = 0;
-	virtual bool remove() = 0;
+	ProfileError getError() const;
+	ProfileFlags getFlags() const;
+	int getUpdateInterval() const;
+	int getUpdateProgress() const;
+	virtual quint64 getMemoryUsage() const = 0;
+	bool update(const QUrl &url = {});
+	virtual bool remove();
 	virtual bool areWildcardsEnabled() const = 0;
-	virtual bool isUpdating() const = 0;
+	bool isUpdating() const;
 	virtual bool isFraud(const QUrl &url) = 0;
+	virtual bool isLoaded() const = 0;
+	bool waitForLoaded(int timeout);
+
+protected:
+	virtual void clearSnapshot() = 0;
+	void cancelLoading();
+	void finishLoading();
+	void finishLoading(quint64 generation, const std::function<void()> &setSnapshot);
+	void raiseError(const QString &message, ProfileError error);
+	void resetError();
+	void setDefaultTitle(const QString &title);
+	void addLoadingFuture(const QFuture<void> &future);
+	quint64 startLoading();
+	virtual bool validateData(const QByteArray &data);
+	bool isLoading() const;
+	bool needsUpdate() const;
+
+protected slots:
+	virtual void loadData(bool isUpdate) = 0;
+	void handleJobFinished(bool isSuccess);
+
+private:
+	DataFetchJob *m_dataFetchJob;
+	ProfileSummary m_profileSummary;
+	mutable QMutex m_mutex;
+	QWaitCondition m_loadingCondition;
+	QFutureSynchronizer<void> m_loadingFutures;
+	ProfileError m_error;
+	ProfileFlags m_flags;
+	quint64 m_generation;
+	bool m_isLoading;
 
 signals:
 	void profileModified();
 	void updateProgressChanged(int progress);
+	void loadingFinished(bool isSuccess);
 };
 
 }
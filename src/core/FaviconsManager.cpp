@@ -0,0 +1,810 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "FaviconsManager.h"
+#include "Application.h"
+#include "Console.h"
+#include "SessionsManager.h"
+#include "Utils.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QBuffer>
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+#include <QtCore/QTimerEvent>
+
+#include <algorithm>
+
+namespace Otter
+{
+
+FaviconsManager* FaviconsManager::m_instance(nullptr);
+
+FaviconsManager::FaviconsManager(QObject *parent) : QObject(parent),
+	m_path(SessionsManager::getWritableDataPath(QLatin1String("favicons"))),
+	m_cache(m_cacheLimit),
+	m_saveTimer(0)
+{
+	load();
+}
+
+FaviconsManager::~FaviconsManager()
+{
+	m_loadingFutures.waitForFinished();
+
+	if (m_saveTimer != 0)
+	{
+		save();
+	}
+}
+
+void FaviconsManager::createInstance()
+{
+	if (!m_instance)
+	{
+		m_instance = new FaviconsManager(QCoreApplication::instance());
+	}
+}
+
+void FaviconsManager::clearIcons(uint period)
+{
+	if (!m_instance)
+	{
+		return;
+	}
+
+	const qint64 limit((period == 0) ? 0 : (QDateTime::currentMSecsSinceEpoch() - (static_cast<qint64>(period) * 3600000)));
+	QSet<QString> hosts;
+	QHash<QString, PageInformation>::iterator iterator(m_instance->m_pages.begin());
+
+	while (iterator != m_instance->m_pages.end())
+	{
+		if (iterator.value().lastUsedTime >= limit && !m_instance->m_pinnedPages.contains(iterator.key()))
+		{
+			hosts.insert(QUrl(iterator.key()).host());
+
+			iterator = m_instance->m_pages.erase(iterator);
+		}
+		else
+		{
+			++iterator;
+		}
+	}
+
+	if (!hosts.isEmpty())
+	{
+		m_instance->removeHosts(hosts);
+		m_instance->scheduleSave();
+	}
+}
+
+void FaviconsManager::removeIcons(const QVector<QUrl> &urls)
+{
+	if (!m_instance)
+	{
+		return;
+	}
+
+	QSet<QString> hosts;
+	QVector<QUrl> removedUrls;
+	removedUrls.reserve(urls.count());
+
+	for (int i = 0; i < urls.count(); ++i)
+	{
+		const QString pageKey(createPageKey(urls.at(i)));
+
+		if (!m_instance->m_pinnedPages.contains(pageKey) && m_instance->m_pages.remove(pageKey) > 0)
+		{
+			hosts.insert(urls.at(i).host());
+
+			removedUrls.append(urls.at(i));
+		}
+	}
+
+	if (removedUrls.isEmpty())
+	{
+		return;
+	}
+
+	m_instance->removeHosts(hosts);
+	m_instance->scheduleSave();
+
+	for (int i = 0; i < removedUrls.count(); ++i)
+	{
+		emit m_instance->iconChanged(removedUrls.at(i));
+	}
+}
+
+void FaviconsManager::pinIcon(const QUrl &url)
+{
+	if (m_instance && !Utils::isUrlEmpty(url))
+	{
+		++m_instance->m_pinnedPages[createPageKey(url)];
+	}
+}
+
+void FaviconsManager::unpinIcon(const QUrl &url)
+{
+	if (!m_instance || Utils::isUrlEmpty(url))
+	{
+		return;
+	}
+
+	const QString pageKey(createPageKey(url));
+
+	if (m_instance->m_pinnedPages.contains(pageKey) && --m_instance->m_pinnedPages[pageKey] <= 0)
+	{
+		m_instance->m_pinnedPages.remove(pageKey);
+	}
+}
+
+void FaviconsManager::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_saveTimer)
+	{
+		killTimer(m_saveTimer);
+
+		m_saveTimer = 0;
+
+		save();
+	}
+}
+
+void FaviconsManager::scheduleSave()
+{
+	if (Application::isAboutToQuit())
+	{
+		save();
+	}
+	else if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void FaviconsManager::load()
+{
+	QFile file(QDir(m_path).filePath(QLatin1String("index.dat")));
+
+	if (!file.exists())
+	{
+		return;
+	}
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		Console::addMessage(tr("Failed to open favicons index: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic(0);
+	quint16 version(0);
+
+	stream >> magic >> version;
+
+	if (magic != m_magic || version > m_version)
+	{
+		Console::addMessage(tr("Failed to load favicons index: unsupported format"), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+
+		return;
+	}
+
+	qint32 iconsAmount(0);
+
+	stream >> iconsAmount;
+
+	for (qint32 i = 0; i < iconsAmount && stream.status() == QDataStream::Ok; ++i)
+	{
+		QString key;
+		qint32 imagesAmount(0);
+
+		stream >> key >> imagesAmount;
+
+		QVector<IconImage> images;
+		images.reserve(qBound(0, imagesAmount, static_cast<int>(m_maximumImagesAmount)));
+
+		for (qint32 j = 0; j < imagesAmount && stream.status() == QDataStream::Ok; ++j)
+		{
+			IconImage image;
+
+			stream >> image.hash >> image.size;
+
+			images.append(image);
+		}
+
+		m_icons[key] = images;
+	}
+
+	qint32 pagesAmount(0);
+
+	stream >> pagesAmount;
+
+	for (qint32 i = 0; i < pagesAmount && stream.status() == QDataStream::Ok; ++i)
+	{
+		QString key;
+		PageInformation page;
+
+		stream >> key >> page.icon >> page.lastUsedTime;
+
+		m_pages[key] = page;
+	}
+
+	qint32 hostsAmount(0);
+
+	stream >> hostsAmount;
+
+	for (qint32 i = 0; i < hostsAmount && stream.status() == QDataStream::Ok; ++i)
+	{
+		QString host;
+		QString icon;
+
+		stream >> host >> icon;
+
+		m_hosts[host] = icon;
+	}
+
+	file.close();
+
+	if (stream.status() != QDataStream::Ok)
+	{
+		Console::addMessage(tr("Failed to load favicons index: file is damaged"), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+
+		m_icons.clear();
+		m_pages.clear();
+		m_hosts.clear();
+	}
+
+	const QStringList images(QDir(m_path).entryList({QLatin1String("*.png")}, QDir::Files));
+
+	for (int i = 0; i < images.count(); ++i)
+	{
+		m_storedImages.insert(images.at(i).section(QLatin1Char('.'), 0, 0));
+	}
+}
+
+void FaviconsManager::save()
+{
+	if (SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	QDir().mkpath(m_path);
+
+	if (m_pages.count() > m_pagesLimit)
+	{
+		QVector<qint64> times;
+		times.reserve(m_pages.count());
+
+		QHash<QString, PageInformation>::const_iterator pagesIterator;
+
+		for (pagesIterator = m_pages.constBegin(); pagesIterator != m_pages.constEnd(); ++pagesIterator)
+		{
+			if (!m_pinnedPages.contains(pagesIterator.key()))
+			{
+				times.append(pagesIterator.value().lastUsedTime);
+			}
+		}
+
+		std::sort(times.begin(), times.end());
+
+		const qint64 limit(times.isEmpty() ? 0 : times.at(qMax(0, (times.count() - m_pagesLimit))));
+		QHash<QString, PageInformation>::iterator iterator(m_pages.begin());
+
+		while (iterator != m_pages.end())
+		{
+			if (iterator.value().lastUsedTime < limit && !m_pinnedPages.contains(iterator.key()))
+			{
+				iterator = m_pages.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
+		}
+	}
+
+	QSet<QString> usedIcons;
+	QHash<QString, PageInformation>::const_iterator pagesIterator;
+
+	for (pagesIterator = m_pages.constBegin(); pagesIterator != m_pages.constEnd(); ++pagesIterator)
+	{
+		usedIcons.insert(pagesIterator.value().icon);
+	}
+
+	QHash<QString, QString>::const_iterator hostsIterator;
+
+	for (hostsIterator = m_hosts.constBegin(); hostsIterator != m_hosts.constEnd(); ++hostsIterator)
+	{
+		usedIcons.insert(hostsIterator.value());
+	}
+
+	QSet<QString> usedImages;
+	QHash<QString, QVector<IconImage> >::iterator iconsIterator(m_icons.begin());
+
+	while (iconsIterator != m_icons.end())
+	{
+		if (usedIcons.contains(iconsIterator.key()))
+		{
+			for (int i = 0; i < iconsIterator.value().count(); ++i)
+			{
+				usedImages.insert(iconsIterator.value().at(i).hash);
+			}
+
+			++iconsIterator;
+		}
+		else
+		{
+			m_cache.remove(iconsIterator.key());
+
+			iconsIterator = m_icons.erase(iconsIterator);
+		}
+	}
+
+	QHash<QString, QByteArray>::iterator imagesIterator(m_pendingImages.begin());
+
+	while (imagesIterator != m_pendingImages.end())
+	{
+		if (!usedImages.contains(imagesIterator.key()))
+		{
+			imagesIterator = m_pendingImages.erase(imagesIterator);
+
+			continue;
+		}
+
+		QFile file(getImagePath(imagesIterator.key()));
+
+		if (file.open(QIODevice::WriteOnly) && file.write(imagesIterator.value()) == imagesIterator.value().size())
+		{
+			m_storedImages.insert(imagesIterator.key());
+
+			imagesIterator = m_pendingImages.erase(imagesIterator);
+		}
+		else
+		{
+			Console::addMessage(tr("Failed to save favicon: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+
+			++imagesIterator;
+		}
+	}
+
+	QSet<QString>::iterator storedImagesIterator(m_storedImages.begin());
+
+	while (storedImagesIterator != m_storedImages.end())
+	{
+		if (usedImages.contains(*storedImagesIterator))
+		{
+			++storedImagesIterator;
+		}
+		else
+		{
+			QFile::remove(getImagePath(*storedImagesIterator));
+
+			storedImagesIterator = m_storedImages.erase(storedImagesIterator);
+		}
+	}
+
+	QSaveFile file(QDir(m_path).filePath(QLatin1String("index.dat")));
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		Console::addMessage(tr("Failed to save favicons index: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+
+		return;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+	stream << m_magic << m_version << static_cast<qint32>(m_icons.count());
+
+	QHash<QString, QVector<IconImage> >::const_iterator iterator;
+
+	for (iterator = m_icons.constBegin(); iterator != m_icons.constEnd(); ++iterator)
+	{
+		stream << iterator.key() << static_cast<qint32>(iterator.value().count());
+
+		for (int i = 0; i < iterator.value().count(); ++i)
+		{
+			stream << iterator.value().at(i).hash << iterator.value().at(i).size;
+		}
+	}
+
+	stream << static_cast<qint32>(m_pages.count());
+
+	for (pagesIterator = m_pages.constBegin(); pagesIterator != m_pages.constEnd(); ++pagesIterator)
+	{
+		stream << pagesIterator.key() << pagesIterator.value().icon << pagesIterator.value().lastUsedTime;
+	}
+
+	stream << static_cast<qint32>(m_hosts.count());
+
+	for (hostsIterator = m_hosts.constBegin(); hostsIterator != m_hosts.constEnd(); ++hostsIterator)
+	{
+		stream << hostsIterator.key() << hostsIterator.value();
+	}
+
+	if (stream.status() != QDataStream::Ok || !file.commit())
+	{
+		Console::addMessage(tr("Failed to save favicons index: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, file.fileName());
+	}
+}
+
+void FaviconsManager::loadIcon(const QString &key, const QUrl &url)
+{
+	if (m_loadingIcons.contains(key))
+	{
+		if (!m_loadingIcons[key].urls.contains(url))
+		{
+			m_loadingIcons[key].urls.append(url);
+		}
+
+		return;
+	}
+
+	const QVector<IconImage> images(m_icons.value(key));
+	QVector<QByteArray> data;
+	QStringList paths;
+
+	for (int i = 0; i < images.count(); ++i)
+	{
+		if (m_pendingImages.contains(images.at(i).hash))
+		{
+			data.append(m_pendingImages.value(images.at(i).hash));
+		}
+		else
+		{
+			paths.append(getImagePath(images.at(i).hash));
+		}
+	}
+
+	LoadingIcon loadingIcon;
+	loadingIcon.images = images;
+	loadingIcon.urls = {url};
+
+	m_loadingIcons[key] = loadingIcon;
+
+	m_loadingFutures.addFuture(QtConcurrent::run([=]()
+	{
+		QVector<QImage> loadedImages;
+		loadedImages.reserve(data.count() + paths.count());
+
+		for (int i = 0; i < data.count(); ++i)
+		{
+			const QImage image(QImage::fromData(data.at(i), "PNG"));
+
+			if (!image.isNull())
+			{
+				loadedImages.append(image);
+			}
+		}
+
+		for (int i = 0; i < paths.count(); ++i)
+		{
+			const QImage image(paths.at(i), "PNG");
+
+			if (!image.isNull())
+			{
+				loadedImages.append(image);
+			}
+		}
+
+		{
+			QMutexLocker locker(&m_loadedIconsMutex);
+
+			m_loadedIcons[key] = loadedImages;
+		}
+
+		QMetaObject::invokeMethod(this, "handleIconsLoaded", Qt::QueuedConnection);
+	}));
+}
+
+void FaviconsManager::removeHosts(const QSet<QString> &hosts)
+{
+	QSet<QString> usedHosts;
+	QHash<QString, PageInformation>::const_iterator iterator;
+
+	for (iterator = m_pages.constBegin(); iterator != m_pages.constEnd(); ++iterator)
+	{
+		const QString host(QUrl(iterator.key()).host());
+
+		if (hosts.contains(host))
+		{
+			usedHosts.insert(host);
+		}
+	}
+
+	QSet<QString>::const_iterator hostsIterator;
+
+	for (hostsIterator = hosts.constBegin(); hostsIterator != hosts.constEnd(); ++hostsIterator)
+	{
+		if (!usedHosts.contains(*hostsIterator))
+		{
+			m_hosts.remove(*hostsIterator);
+		}
+	}
+}
+
+void FaviconsManager::handleIconsLoaded()
+{
+	QHash<QString, QVector<QImage> > loadedIcons;
+
+	{
+		QMutexLocker locker(&m_loadedIconsMutex);
+
+		loadedIcons.swap(m_loadedIcons);
+	}
+
+	QHash<QString, QVector<QImage> >::const_iterator iterator;
+
+	for (iterator = loadedIcons.constBegin(); iterator != loadedIcons.constEnd(); ++iterator)
+	{
+		const LoadingIcon loadingIcon(m_loadingIcons.take(iterator.key()));
+		const QVector<QImage> images(iterator.value());
+
+		if (m_icons.value(iterator.key()) != loadingIcon.images)
+		{
+			for (int i = 0; i < loadingIcon.urls.count(); ++i)
+			{
+				emit iconChanged(loadingIcon.urls.at(i));
+			}
+
+			continue;
+		}
+
+		if (images.isEmpty())
+		{
+			m_icons.remove(iterator.key());
+
+			continue;
+		}
+
+		QIcon *icon(new QIcon());
+		int cost(0);
+
+		for (int i = 0; i < images.count(); ++i)
+		{
+			icon->addPixmap(QPixmap::fromImage(images.at(i)));
+
+			cost += (images.at(i).width() * images.at(i).height() * 4);
+		}
+
+		m_cache.insert(iterator.key(), icon, qMax(1, (cost / 1024)));
+
+		for (int i = 0; i < loadingIcon.urls.count(); ++i)
+		{
+			emit iconChanged(loadingIcon.urls.at(i));
+		}
+	}
+
+	if (m_loadingIcons.isEmpty())
+	{
+		m_loadingFutures.clearFutures();
+	}
+}
+
+void FaviconsManager::setIcon(const QUrl &url, const QIcon &icon, const QUrl &iconUrl)
+{
+	if (!m_instance || icon.isNull() || Utils::isUrlEmpty(url))
+	{
+		return;
+	}
+
+	const QString pageKey(createPageKey(url));
+
+	if (m_instance->m_pages.contains(pageKey))
+	{
+		PageInformation &page(m_instance->m_pages[pageKey]);
+
+		if ((iconUrl.isValid() && page.icon == iconUrl.toString() && m_instance->m_icons.contains(page.icon)) || m_instance->isCachedIcon(page.icon, icon))
+		{
+			page.lastUsedTime = QDateTime::currentMSecsSinceEpoch();
+
+			return;
+		}
+	}
+
+	QList<QSize> sizes(icon.availableSizes());
+
+	if (sizes.isEmpty())
+	{
+		sizes.append(QSize(16, 16));
+	}
+
+	QVector<IconImage> images;
+	int cost(0);
+
+	for (int i = 0; i < sizes.count() && images.count() < m_maximumImagesAmount; ++i)
+	{
+		if (sizes.at(i).width() > m_maximumImageSize || sizes.at(i).height() > m_maximumImageSize)
+		{
+			continue;
+		}
+
+		const QPixmap pixmap(icon.pixmap(sizes.at(i)));
+		QByteArray data;
+		QBuffer buffer(&data);
+		buffer.open(QIODevice::WriteOnly);
+
+		if (pixmap.isNull() || !pixmap.save(&buffer, "PNG"))
+		{
+			continue;
+		}
+
+		IconImage image;
+		image.hash = QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+		image.size = pixmap.size();
+
+		bool isDuplicate(false);
+
+		for (int j = 0; j < images.count(); ++j)
+		{
+			if (images.at(j).hash == image.hash)
+			{
+				isDuplicate = true;
+
+				break;
+			}
+		}
+
+		if (isDuplicate)
+		{
+			continue;
+		}
+
+		if (!m_instance->m_storedImages.contains(image.hash))
+		{
+			m_instance->m_pendingImages[image.hash] = data;
+		}
+
+		cost += (pixmap.width() * pixmap.height() * 4);
+
+		images.append(image);
+	}
+
+	if (images.isEmpty())
+	{
+		return;
+	}
+
+	const QString key(iconUrl.isValid() ? iconUrl.toString() : (QLatin1String("hash:") + images.first().hash));
+	const QString host(url.host());
+	PageInformation page;
+	page.icon = key;
+	page.lastUsedTime = QDateTime::currentMSecsSinceEpoch();
+
+	m_instance->m_icons[key] = images;
+	m_instance->m_pages[pageKey] = page;
+	m_instance->m_cache.insert(key, new QIcon(icon), qMax(1, (cost / 1024)));
+
+	if (!host.isEmpty() && (!m_instance->m_hosts.contains(host) || url.path().length() <= 1))
+	{
+		m_instance->m_hosts[host] = key;
+	}
+
+	m_instance->scheduleSave();
+
+	emit m_instance->iconChanged(url);
+}
+
+FaviconsManager* FaviconsManager::getInstance()
+{
+	return m_instance;
+}
+
+QString FaviconsManager::createPageKey(const QUrl &url)
+{
+	return Utils::normalizeUrl(url).adjusted(QUrl::RemoveFragment).toString();
+}
+
+QString FaviconsManager::getIconKey(const QUrl &url) const
+{
+	const QString pageKey(createPageKey(url));
+
+	if (m_pages.contains(pageKey) && m_icons.contains(m_pages[pageKey].icon))
+	{
+		return m_pages[pageKey].icon;
+	}
+
+	const QString key(m_hosts.value(url.host()));
+
+	return (m_icons.contains(key) ? key : QString());
+}
+
+QString FaviconsManager::getImagePath(const QString &hash) const
+{
+	return QDir(m_path).filePath(hash + QLatin1String(".png"));
+}
+
+QIcon FaviconsManager::getIcon(const QUrl &url)
+{
+	if (!m_instance || Utils::isUrlEmpty(url))
+	{
+		return {};
+	}
+
+	const QString key(m_instance->getIconKey(url));
+
+	if (key.isEmpty())
+	{
+		return {};
+	}
+
+	const QIcon *icon(m_instance->m_cache.object(key));
+
+	if (icon)
+	{
+		return *icon;
+	}
+
+	m_instance->loadIcon(key, url);
+
+	return {};
+}
+
+bool FaviconsManager::isCachedIcon(const QString &key, const QIcon &icon) const
+{
+	const QIcon *cachedIcon(m_cache.object(key));
+
+	if (!cachedIcon)
+	{
+		return false;
+	}
+
+	if (cachedIcon->cacheKey() == icon.cacheKey())
+	{
+		return true;
+	}
+
+	QList<QSize> sizes(icon.availableSizes());
+
+	if (sizes != cachedIcon->availableSizes())
+	{
+		return false;
+	}
+
+	if (sizes.isEmpty())
+	{
+		sizes.append(QSize(16, 16));
+	}
+
+	for (int i = 0; i < sizes.count(); ++i)
+	{
+		if (icon.pixmap(sizes.at(i)).toImage() != cachedIcon->pixmap(sizes.at(i)).toImage())
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FaviconsManager::hasIcon(const QUrl &url)
+{
+	return (m_instance && !Utils::isUrlEmpty(url) && !m_instance->getIconKey(url).isEmpty());
+}
+
+}
@@ -0,0 +1,122 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_FAVICONSMANAGER_H
+#define OTTER_FAVICONSMANAGER_H
+
+#include <QtCore/QCache>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QMutex>
+#include <QtCore/QSet>
+#include <QtCore/QSize>
+#include <QtCore/QUrl>
+#include <QtGui/QIcon>
+#include <QtGui/QImage>
+#include <QtGui/QPixmap>
+
+namespace Otter
+{
+
+class FaviconsManager final : public QObject
+{
+	Q_OBJECT
+
+public:
+	~FaviconsManager();
+
+	static void createInstance();
+	static void clearIcons(uint period = 0);
+	static void removeIcons(const QVector<QUrl> &urls);
+	static void pinIcon(const QUrl &url);
+	static void unpinIcon(const QUrl &url);
+	static void setIcon(const QUrl &url, const QIcon &icon, const QUrl &iconUrl = {});
+	static FaviconsManager* getInstance();
+	static QIcon getIcon(const QUrl &url);
+	static bool hasIcon(const QUrl &url);
+
+protected:
+	struct IconImage final
+	{
+		QString hash;
+		QSize size;
+
+		bool operator==(const IconImage &other) const
+		{
+			return (hash == other.hash && size == other.size);
+		}
+	};
+
+	struct LoadingIcon final
+	{
+		QVector<IconImage> images;
+		QVector<QUrl> urls;
+	};
+
+	struct PageInformation final
+	{
+		QString icon;
+		qint64 lastUsedTime = 0;
+	};
+
+	explicit FaviconsManager(QObject *parent);
+
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleSave();
+	void load();
+	void save();
+	void loadIcon(const QString &key, const QUrl &url);
+	void removeHosts(const QSet<QString> &hosts);
+	QString getIconKey(const QUrl &url) const;
+	QString getImagePath(const QString &hash) const;
+	bool isCachedIcon(const QString &key, const QIcon &icon) const;
+	static QString createPageKey(const QUrl &url);
+
+protected slots:
+	void handleIconsLoaded();
+
+private:
+	QString m_path;
+	QCache<QString, QIcon> m_cache;
+	QHash<QString, QVector<IconImage> > m_icons;
+	QHash<QString, PageInformation> m_pages;
+	QHash<QString, QString> m_hosts;
+	QHash<QString, int> m_pinnedPages;
+	QHash<QString, LoadingIcon> m_loadingIcons;
+	QHash<QString, QVector<QImage> > m_loadedIcons;
+	QHash<QString, QByteArray> m_pendingImages;
+	QSet<QString> m_storedImages;
+	QMutex m_loadedIconsMutex;
+	QFutureSynchronizer<void> m_loadingFutures;
+	int m_saveTimer;
+
+	static FaviconsManager *m_instance;
+	static const quint32 m_magic = 0x4F46564E;
+	static const quint16 m_version = 1;
+	static const int m_cacheLimit = 4096;
+	static const int m_pagesLimit = 10000;
+	static const int m_maximumImagesAmount = 4;
+	static const int m_maximumImageSize = 256;
+
+signals:
+	void iconChanged(const QUrl &url);
+};
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "Application.h"
 #include "BookmarksManager.h"
 #include "Console.h"
+#include "FaviconsManager.h"
 #include "FeedParser.h"
 #include "Job.h"
 #include "LongTermTimer.h"
@@ -42,13 +43,19 @@ Feed::Feed(const QString &title, const QUrl &url, const QIcon &icon, int updateI
 	m_parser(nullptr),
 	m_title(title),
 	m_url(url),
-	m_icon(icon),
 	m_error(NoError),
 	m_updateInterval(0),
 	m_updateProgress(-1),
 	m_isUpdating(false)
 {
 	setUpdateInterval(updateInterval);
+
+	FaviconsManager::pinIcon(url);
+
+	if (!icon.isNull() && !FaviconsManager::hasIcon(url))
+	{
+		FaviconsManager::setIcon(url, icon);
+	}
 }
 
 void Feed::markEntryAsRead(const QString &identifier)
@@ -110,6 +117,9 @@ void Feed::setUrl(const QUrl &url)
 {
 	if (url != m_url)
 	{
+		FaviconsManager::unpinIcon(m_url);
+		FaviconsManager::pinIcon(url);
+
 		m_url = url;
 
 		update();
@@ -120,7 +130,7 @@ void Feed::setUrl(const QUrl &url)
 
 void Feed::setIcon(const QIcon &icon)
 {
-	m_icon = icon;
+	FaviconsManager::setIcon(m_url, icon);
 
 	emit feedModified(this);
 }
@@ -216,7 +226,7 @@ void Feed::update()
 						m_error = ParseError;
 					}
 
-					if (m_icon.isNull() && information.icon.isValid())
+					if (!FaviconsManager::hasIcon(m_url) && information.icon.isValid())
 					{
 						IconFetchJob *iconJob(new IconFetchJob(information.icon, this));
 
@@ -383,7 +393,7 @@ QUrl Feed::getUrl() const
 
 QIcon Feed::getIcon() const
 {
-	return m_icon;
+	return FaviconsManager::getIcon(m_url);
 }
 
 QDateTime Feed::getLastUpdateTime() const
@@ -540,11 +550,6 @@ void FeedsManager::timerEvent(QTimerEvent *event)
 				feedObject.insert(QLatin1String("description"), feed->getDescription());
 			}
 
-			if (!feed->getIcon().isNull())
-			{
-				feedObject.insert(QLatin1String("icon"), Utils::savePixmapAsDataUri(feed->getIcon().pixmap(feed->getIcon().availableSizes().value(0, {16, 16}))));
-			}
-
 			if (!categories.isEmpty())
 			{
 				QMap<QString, QString>::const_iterator iterator;
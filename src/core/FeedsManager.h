@@ -103,7 +103,6 @@ private:
 	QString m_title;
 	QString m_description;
 	QUrl m_url;
-	QIcon m_icon;
 	QDateTime m_lastUpdateTime;
 	QDateTime m_lastSynchronizationTime;
 	QMimeType m_mimeType;
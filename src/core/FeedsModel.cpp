@@ -20,6 +20,7 @@
 #include "FeedsModel.h"
 #include "Application.h"
 #include "Console.h"
+#include "FaviconsManager.h"
 #include "FeedsManager.h"
 #include "SessionsManager.h"
 #include "ThemesManager.h"
@@ -292,6 +293,8 @@ FeedsModel::FeedsModel(const QString &path, QObject *parent) : QStandardItemMode
 	appendRow(m_trashEntry);
 	setItemPrototype(new Entry());
 
+	connect(FaviconsManager::getInstance(), &FaviconsManager::iconChanged, this, &FeedsModel::handleIconChanged);
+
 	if (!QFile::exists(path))
 	{
 		return;
@@ -663,6 +666,18 @@ void FeedsModel::handleUrlChanged(Entry *entry, const QUrl &newUrl, const QUrl &
 	}
 }
 
+void FeedsModel::handleIconChanged(const QUrl &url)
+{
+	const QVector<Entry*> entries(getEntries(url));
+
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		const QModelIndex index(entries.at(i)->index());
+
+		emit dataChanged(index, index, {Qt::DecorationRole});
+	}
+}
+
 FeedsModel::Entry* FeedsModel::addEntry(EntryType type, const QMap<int, QVariant> &metaData, Entry *parent, int index)
 {
 	Entry *entry(new Entry());
@@ -120,6 +120,9 @@ protected:
 	void createIdentifier(Entry *entry);
 	void handleUrlChanged(Entry *entry, const QUrl &newUrl, const QUrl &oldUrl = {});
 
+protected slots:
+	void handleIconChanged(const QUrl &url);
+
 private:
 	Entry *m_rootEntry;
 	Entry *m_trashEntry;
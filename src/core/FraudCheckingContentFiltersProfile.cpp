@@ -0,0 +1,350 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "FraudCheckingContentFiltersProfile.h"
+#include "SessionsManager.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QFile>
+#include <QtCore/QTextStream>
+
+#include <algorithm>
+
+namespace Otter
+{
+
+FraudCheckingContentFiltersProfile::FraudCheckingContentFiltersProfile(const ContentFiltersProfile::ProfileSummary &profileSummary, ContentFiltersProfile::ProfileFlags flags, QObject *parent) : ContentFiltersProfile(profileSummary, flags, parent)
+{
+}
+
+FraudCheckingContentFiltersProfile::~FraudCheckingContentFiltersProfile()
+{
+	cancelLoading();
+}
+
+void FraudCheckingContentFiltersProfile::loadData(bool isUpdate)
+{
+	Q_UNUSED(isUpdate)
+
+	const QString path(getPath());
+
+	resetError();
+
+	if (!QFile::exists(path))
+	{
+		startLoading();
+
+		if (getUpdateUrl().isEmpty() || (!isUpdating() && !update()))
+		{
+			finishLoading();
+		}
+
+		return;
+	}
+
+	const quint64 generation(startLoading());
+
+	addLoadingFuture(QtConcurrent::run(this, &FraudCheckingContentFiltersProfile::createSnapshot, path, generation));
+
+	if (needsUpdate())
+	{
+		update();
+	}
+}
+
+void FraudCheckingContentFiltersProfile::createSnapshot(const QString &path, quint64 generation)
+{
+	QFile file(path);
+
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+	{
+		finishLoading();
+
+		return;
+	}
+
+	std::shared_ptr<PrefixesSnapshot> snapshot(std::make_shared<PrefixesSnapshot>());
+	QTextStream stream(&file);
+	stream.setCodec("UTF-8");
+
+	while (!stream.atEnd())
+	{
+		const QString expression(createExpression(stream.readLine()));
+
+		if (!expression.isEmpty())
+		{
+			snapshot->hashes.append(createHash(expression));
+		}
+	}
+
+	file.close();
+
+	std::sort(snapshot->hashes.begin(), snapshot->hashes.end());
+
+	snapshot->hashes.erase(std::unique(snapshot->hashes.begin(), snapshot->hashes.end()), snapshot->hashes.end());
+	snapshot->hashes.squeeze();
+
+	const int bucketsAmount(1 << m_bucketBits);
+	int index(0);
+
+	snapshot->buckets.resize(bucketsAmount + 1);
+
+	for (int i = 0; i < bucketsAmount; ++i)
+	{
+		snapshot->buckets[i] = static_cast<quint32>(index);
+
+		while (index < snapshot->hashes.count() && (snapshot->hashes.at(index) >> (64 - m_bucketBits)) == static_cast<quint64>(i))
+		{
+			++index;
+		}
+	}
+
+	snapshot->buckets[bucketsAmount] = static_cast<quint32>(snapshot->hashes.count());
+
+	finishLoading(generation, [&]()
+	{
+		setSnapshot(snapshot);
+	});
+}
+
+void FraudCheckingContentFiltersProfile::clearSnapshot()
+{
+	setSnapshot({});
+}
+
+void FraudCheckingContentFiltersProfile::setSnapshot(const std::shared_ptr<const PrefixesSnapshot> &snapshot)
+{
+	std::atomic_store(&m_snapshot, snapshot);
+}
+
+QString FraudCheckingContentFiltersProfile::getPath() const
+{
+	return SessionsManager::getWritableDataPath(QLatin1String("fraudChecking/%1.txt")).arg(getName());
+}
+
+QString FraudCheckingContentFiltersProfile::createExpression(const QString &line)
+{
+	QString expression(line.trimmed());
+
+	if (expression.isEmpty() || expression.startsWith(QLatin1Char('!')) || expression.startsWith(QLatin1Char('#')) || expression.startsWith(QLatin1Char('[')))
+	{
+		return {};
+	}
+
+	const int schemePosition(expression.indexOf(QLatin1String("://")));
+
+	if (schemePosition >= 0)
+	{
+		expression = expression.mid(schemePosition + 3);
+	}
+
+	const int fragmentPosition(expression.indexOf(QLatin1Char('#')));
+
+	if (fragmentPosition >= 0)
+	{
+		expression.truncate(fragmentPosition);
+	}
+
+	const int pathPosition(expression.indexOf(QLatin1Char('/')));
+	QString host(expression.left(pathPosition));
+	const int portPosition(host.lastIndexOf(QLatin1Char(':')));
+
+	if (portPosition >= 0 && !host.endsWith(QLatin1Char(']')))
+	{
+		host.truncate(portPosition);
+	}
+
+	while (host.endsWith(QLatin1Char('.')))
+	{
+		host.chop(1);
+	}
+
+	host = QString::fromLatin1(QUrl::toAce(host)).toLower();
+
+	if (host.isEmpty())
+	{
+		return {};
+	}
+
+	return host + ((pathPosition >= 0) ? expression.mid(pathPosition) : QString(QLatin1Char('/')));
+}
+
+QStringList FraudCheckingContentFiltersProfile::createPathPrefixes(const QUrl &url)
+{
+	QString path(url.path(QUrl::FullyEncoded));
+
+	if (path.isEmpty())
+	{
+		path = QLatin1String("/");
+	}
+
+	QStringList prefixes;
+	prefixes.reserve(m_maximumPathComponents + 2);
+
+	if (url.hasQuery())
+	{
+		prefixes.append(path + QLatin1Char('?') + url.query(QUrl::FullyEncoded));
+	}
+
+	prefixes.append(path);
+
+	int position(0);
+
+	for (int i = 0; i <= m_maximumPathComponents && position >= 0; ++i)
+	{
+		const QString prefix(path.left(position + 1));
+
+		if (!prefixes.contains(prefix))
+		{
+			prefixes.append(prefix);
+		}
+
+		position = path.indexOf(QLatin1Char('/'), (position + 1));
+	}
+
+	return prefixes;
+}
+
+ContentFiltersManager::CheckResult FraudCheckingContentFiltersProfile::checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType)
+{
+	Q_UNUSED(baseUrl)
+	Q_UNUSED(requestUrl)
+	Q_UNUSED(resourceType)
+
+	return {};
+}
+
+ContentFiltersManager::CosmeticFiltersResult FraudCheckingContentFiltersProfile::getCosmeticFilters(const QStringList &domains, bool isDomainOnly)
+{
+	Q_UNUSED(domains)
+	Q_UNUSED(isDomainOnly)
+
+	return {};
+}
+
+ContentFiltersManager::CosmeticFiltersResult FraudCheckingContentFiltersProfile::getCosmeticFilters(const QStringList &domains, const QStringList &identifiers, const QStringList &classes)
+{
+	Q_UNUSED(domains)
+	Q_UNUSED(identifiers)
+	Q_UNUSED(classes)
+
+	return {};
+}
+
+std::shared_ptr<const FraudCheckingContentFiltersProfile::PrefixesSnapshot> FraudCheckingContentFiltersProfile::getSnapshot() const
+{
+	return std::atomic_load(&m_snapshot);
+}
+
+QVector<QLocale::Language> FraudCheckingContentFiltersProfile::getLanguages() const
+{
+	return {QLocale::AnyLanguage};
+}
+
+ContentFiltersManager::CosmeticFiltersMode FraudCheckingContentFiltersProfile::getCosmeticFiltersMode() const
+{
+	return ContentFiltersManager::NoFilters;
+}
+
+quint64 FraudCheckingContentFiltersProfile::getMemoryUsage() const
+{
+	const std::shared_ptr<const PrefixesSnapshot> snapshot(getSnapshot());
+
+	if (!snapshot)
+	{
+		return 0;
+	}
+
+	return (sizeof(PrefixesSnapshot) + (static_cast<quint64>(snapshot->hashes.capacity()) * sizeof(quint64)) + (static_cast<quint64>(snapshot->buckets.capacity()) * sizeof(quint32)));
+}
+
+quint64 FraudCheckingContentFiltersProfile::createHash(const QString &expression)
+{
+	const QByteArray data(expression.toUtf8());
+	quint64 hash(14695981039346656037ULL);
+
+	for (int i = 0; i < data.count(); ++i)
+	{
+		hash ^= static_cast<quint8>(data.at(i));
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+bool FraudCheckingContentFiltersProfile::containsHash(const PrefixesSnapshot &snapshot, quint64 hash) const
+{
+	const int bucket(static_cast<int>(hash >> (64 - m_bucketBits)));
+
+	return std::binary_search((snapshot.hashes.constBegin() + snapshot.buckets.at(bucket)), (snapshot.hashes.constBegin() + snapshot.buckets.at(bucket + 1)), hash);
+}
+
+bool FraudCheckingContentFiltersProfile::areWildcardsEnabled() const
+{
+	return false;
+}
+
+bool FraudCheckingContentFiltersProfile::isFraud(const QUrl &url)
+{
+	const QString scheme(url.scheme());
+
+	if (scheme != QLatin1String("http") && scheme != QLatin1String("https"))
+	{
+		return false;
+	}
+
+	const std::shared_ptr<const PrefixesSnapshot> snapshot(getSnapshot());
+
+	if (!snapshot)
+	{
+		load();
+
+		return false;
+	}
+
+	const QString host(url.host(QUrl::FullyEncoded));
+
+	if (host.isEmpty() || snapshot->hashes.isEmpty())
+	{
+		return false;
+	}
+
+	const QStringList hosts(ContentFiltersManager::createSubdomainList(host));
+	const QStringList paths(createPathPrefixes(url));
+
+	for (int i = (hosts.count() - 1); i >= 0; --i)
+	{
+		for (int j = 0; j < paths.count(); ++j)
+		{
+			if (containsHash(*snapshot, createHash(hosts.at(i) + paths.at(j))))
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool FraudCheckingContentFiltersProfile::isLoaded() const
+{
+	return (getSnapshot() != nullptr);
+}
+
+}
@@ -0,0 +1,77 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_FRAUDCHECKINGCONTENTFILTERSPROFILE_H
+#define OTTER_FRAUDCHECKINGCONTENTFILTERSPROFILE_H
+
+#include "ContentFiltersManager.h"
+
+#include <memory>
+
+namespace Otter
+{
+
+class FraudCheckingContentFiltersProfile final : public ContentFiltersProfile
+{
+	Q_OBJECT
+
+public:
+	explicit FraudCheckingContentFiltersProfile(const ProfileSummary &profileSummary, ProfileFlags flags, QObject *parent = nullptr);
+	~FraudCheckingContentFiltersProfile();
+
+	QString getPath() const override;
+	ContentFiltersManager::CheckResult checkUrl(const QUrl &baseUrl, const QUrl &requestUrl, NetworkManager::ResourceType resourceType) override;
+	ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, bool isDomainOnly) override;
+	ContentFiltersManager::CosmeticFiltersResult getCosmeticFilters(const QStringList &domains, const QStringList &identifiers, const QStringList &classes) override;
+	QVector<QLocale::Language> getLanguages() const override;
+	ContentFiltersManager::CosmeticFiltersMode getCosmeticFiltersMode() const override;
+	quint64 getMemoryUsage() const override;
+	bool areWildcardsEnabled() const override;
+	bool isFraud(const QUrl &url) override;
+	bool isLoaded() const override;
+
+protected:
+	struct PrefixesSnapshot final
+	{
+		QVector<quint64> hashes;
+		QVector<quint32> buckets;
+	};
+
+	void createSnapshot(const QString &path, quint64 generation);
+	void clearSnapshot() override;
+	void setSnapshot(const std::shared_ptr<const PrefixesSnapshot> &snapshot);
+	std::shared_ptr<const PrefixesSnapshot> getSnapshot() const;
+	static QString createExpression(const QString &line);
+	static quint64 createHash(const QString &expression);
+	static QStringList createPathPrefixes(const QUrl &url);
+	bool containsHash(const PrefixesSnapshot &snapshot, quint64 hash) const;
+
+protected slots:
+	void loadData(bool isUpdate) override;
+
+private:
+	std::shared_ptr<const PrefixesSnapshot> m_snapshot;
+
+	static const int m_bucketBits = 16;
+	static const int m_maximumPathComponents = 4;
+};
+
+}
+
+#endif
@@ -21,6 +21,7 @@
 #include "HistoryManager.h"
 #include "AddonsManager.h"
 #include "Application.h"
+#include "FaviconsManager.h"
 #include "SessionsManager.h"
 #include "SettingsManager.h"
 #include "ThemesManager.h"
@@ -108,12 +109,12 @@ void HistoryManager::save()
 {
 	if (m_browsingHistoryModel)
 	{
-		m_browsingHistoryModel->save(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json")));
+		m_browsingHistoryModel->save();
 	}
 
 	if (m_typedHistoryModel)
 	{
-		m_typedHistoryModel->save(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.json")));
+		m_typedHistoryModel->save();
 	}
 }
 
@@ -131,6 +132,8 @@ void HistoryManager::clearHistory(uint period)
 
 	m_browsingHistoryModel->clearRecentEntries(period);
 	m_typedHistoryModel->clearRecentEntries(period);
+
+	FaviconsManager::clearIcons(period);
 }
 
 void HistoryManager::removeEntry(quint64 identifier)
@@ -145,7 +148,14 @@ void HistoryManager::removeEntry(quint64 identifier)
 		getBrowsingHistoryModel();
 	}
 
+	const QUrl url(m_browsingHistoryModel->getEntry(identifier).url);
+
 	m_browsingHistoryModel->removeEntry(identifier);
+
+	if (url.isValid() && !m_browsingHistoryModel->hasEntry(url))
+	{
+		FaviconsManager::removeIcons({url});
+	}
 }
 
 void HistoryManager::removeEntries(const QVector<quint64> &identifiers)
@@ -160,13 +170,33 @@ void HistoryManager::removeEntries(const QVector<quint64> &identifiers)
 		getBrowsingHistoryModel();
 	}
 
+	QVector<QUrl> urls;
+	urls.reserve(identifiers.count());
+
 	for (int i = 0; i < identifiers.count(); ++i)
 	{
-		m_browsingHistoryModel->removeEntry(identifiers.at(i));
+		const QUrl url(m_browsingHistoryModel->getEntry(identifiers.at(i)).url);
+
+		if (url.isValid() && !urls.contains(url))
+		{
+			urls.append(url);
+		}
+	}
+
+	m_browsingHistoryModel->removeEntries(identifiers);
+
+	for (int i = (urls.count() - 1); i >= 0; --i)
+	{
+		if (m_browsingHistoryModel->hasEntry(urls.at(i)))
+		{
+			urls.remove(i);
+		}
 	}
+
+	FaviconsManager::removeIcons(urls);
 }
 
-void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QString &title, const QIcon &icon)
+void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QString &title, const QIcon &icon, const QUrl &iconUrl)
 {
 	if (!m_isEnabled || !url.isValid())
 	{
@@ -185,14 +215,13 @@ void HistoryManager::updateEntry(quint64 identifier, const QUrl &url, const QStr
 		getBrowsingHistoryModel();
 	}
 
-	HistoryModel::Entry *entry(m_browsingHistoryModel->getEntry(identifier));
-
-	if (entry)
+	if (m_isStoringFavicons)
 	{
-		entry->setData(url, HistoryModel::UrlRole);
-		entry->setData(title, HistoryModel::TitleRole);
-		entry->setIcon(icon);
+		FaviconsManager::setIcon(url, icon, iconUrl);
+	}
 
+	if (m_browsingHistoryModel->updateEntry(identifier, url, title))
+	{
 		m_instance->scheduleSave();
 	}
 }
@@ -239,6 +268,11 @@ void HistoryManager::handleOptionChanged(int identifier)
 		case SettingsManager::History_StoreFaviconsOption:
 			m_isStoringFavicons = SettingsManager::getOption(identifier).toBool();
 
+			if (!m_isStoringFavicons)
+			{
+				FaviconsManager::clearIcons();
+			}
+
 			break;
 		default:
 			break;
@@ -254,7 +288,7 @@ HistoryModel* HistoryManager::getBrowsingHistoryModel()
 {
 	if (!m_browsingHistoryModel)
 	{
-		m_browsingHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.json")), HistoryModel::BrowsingHistory, m_instance);
+		m_browsingHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("browsingHistory.dat")), HistoryModel::BrowsingHistory, m_instance);
 
 		connect(m_browsingHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
 	}
@@ -266,7 +300,7 @@ HistoryModel* HistoryManager::getTypedHistoryModel()
 {
 	if (!m_typedHistoryModel && m_instance)
 	{
-		m_typedHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.json")), HistoryModel::TypedHistory, m_instance);
+		m_typedHistoryModel = new HistoryModel(SessionsManager::getWritableDataPath(QLatin1String("typedHistory.dat")), HistoryModel::TypedHistory, m_instance);
 
 		connect(m_typedHistoryModel, &HistoryModel::modelModified, m_instance, &HistoryManager::scheduleSave);
 	}
@@ -306,12 +340,12 @@ QIcon HistoryManager::getIcon(const QUrl &url)
 		}
 	}
 
-///TODO
+	const QIcon icon(FaviconsManager::getIcon(url));
 
-	return ThemesManager::createIcon(QLatin1String("text-html"));
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
-HistoryModel::Entry* HistoryManager::getEntry(quint64 identifier)
+HistoryModel::Entry HistoryManager::getEntry(quint64 identifier)
 {
 	if (!m_browsingHistoryModel)
 	{
@@ -355,7 +389,12 @@ quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QI
 		getBrowsingHistoryModel();
 	}
 
-	const quint64 identifier(m_browsingHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc())->getIdentifier());
+	if (m_isStoringFavicons)
+	{
+		FaviconsManager::setIcon(url, icon);
+	}
+
+	const quint64 identifier(m_browsingHistoryModel->addEntry(url, title, QDateTime::currentDateTimeUtc()));
 
 	if (isTypedIn)
 	{
@@ -364,18 +403,10 @@ quint64 HistoryManager::addEntry(const QUrl &url, const QString &title, const QI
 			getTypedHistoryModel();
 		}
 
-		m_typedHistoryModel->addEntry(url, title, icon, QDateTime::currentDateTimeUtc());
+		m_typedHistoryModel->addEntry(url, title, QDateTime::currentDateTimeUtc());
 	}
 
-	const int limit(SettingsManager::getOption(SettingsManager::History_BrowsingLimitAmountGlobalOption).toInt());
-
-	if (limit > 0 && m_browsingHistoryModel->rowCount() > limit)
-	{
-		for (int i = (m_browsingHistoryModel->rowCount() - 1); i >= limit; --i)
-		{
-			m_browsingHistoryModel->removeEntry(m_browsingHistoryModel->index(i, 0).data(HistoryModel::IdentifierRole).toULongLong());
-		}
-	}
+	m_browsingHistoryModel->clearExcessEntries(SettingsManager::getOption(SettingsManager::History_BrowsingLimitAmountGlobalOption).toInt());
 
 	return identifier;
 }
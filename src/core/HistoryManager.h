@@ -38,13 +38,13 @@ public:
 	static void clearHistory(uint period = 0);
 	static void removeEntry(quint64 identifier);
 	static void removeEntries(const QVector<quint64> &identifiers);
-	static void updateEntry(quint64 identifier, const QUrl &url, const QString &title = {}, const QIcon &icon = {});
+	static void updateEntry(quint64 identifier, const QUrl &url, const QString &title = {}, const QIcon &icon = {}, const QUrl &iconUrl = {});
 	static HistoryManager* getInstance();
 	static HistoryModel* getBrowsingHistoryModel();
 	static HistoryModel* getTypedHistoryModel();
 	static QDateTime getLastVisitTime(const QUrl &url);
 	static QIcon getIcon(const QUrl &url);
-	static HistoryModel::Entry* getEntry(quint64 identifier);
+	static HistoryModel::Entry getEntry(quint64 identifier);
 	static QVector<HistoryModel::HistoryEntryMatch> findEntries(const QString &prefix, bool isTypedInOnly = false);
 	static quint64 addEntry(const QUrl &url, const QString &title = {}, const QIcon &icon = {}, bool isTypedIn = false);
 	static bool hasEntry(const QUrl &url);
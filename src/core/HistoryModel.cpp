@@ -17,69 +17,157 @@
 * along with this program. If not, see <http://www.gnu.org/licenses/>.
 *
 **************************************************************************/
-
 #include "HistoryModel.h"
 #include "Console.h"
-#include "JsonSettings.h"
+#include "FaviconsManager.h"
 #include "SessionsManager.h"
 #include "ThemesManager.h"
 #include "Utils.h"
 
+#include <QtCore/QDir>
 #include <QtCore/QFile>
+#include <QtCore/QFileInfo>
 #include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
+#include <QtCore/QRegularExpression>
+
+#include <algorithm>
 
 namespace Otter
 {
 
-HistoryModel::Entry::Entry() = default;
+QString HistoryModel::Entry::getTitle() const
+{
+	return (title.isEmpty() ? QCoreApplication::translate("Otter::HistoryEntryItem", "(Untitled)") : title);
+}
 
-void HistoryModel::Entry::setData(const QVariant &value, int role)
+QIcon HistoryModel::Entry::getIcon() const
 {
-	if (model() && qobject_cast<HistoryModel*>(model()))
-	{
-		model()->setData(index(), value, role);
-	}
-	else
-	{
-		QStandardItem::setData(value, role);
-	}
+	const QIcon icon(FaviconsManager::getIcon(url));
+
+	return (icon.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : icon);
 }
 
-void HistoryModel::Entry::setItemData(const QVariant &value, int role)
+bool HistoryModel::Entry::isValid() const
 {
-	QStandardItem::setData(value, role);
+	return (identifier > 0);
 }
 
-QString HistoryModel::Entry::getTitle() const
+HistoryModel::StringsTable::StringsTable()
+{
+	clear();
+}
+
+void HistoryModel::StringsTable::clear()
 {
-	return (data(TitleRole).isNull() ? QCoreApplication::translate("Otter::HistoryEntryItem", "(Untitled)") : data(TitleRole).toString());
+	m_strings = {QString()};
+	m_references = {0};
+	m_freeIdentifiers.clear();
+	m_identifiers.clear();
 }
 
-QUrl HistoryModel::Entry::getUrl() const
+void HistoryModel::StringsTable::release(quint32 identifier)
 {
-	return data(UrlRole).toUrl();
+	if (identifier == 0 || static_cast<int>(identifier) >= m_references.count() || m_references.at(identifier) == 0)
+	{
+		return;
+	}
+
+	--m_references[identifier];
+
+	if (m_references.at(identifier) == 0)
+	{
+		m_identifiers.remove(m_strings.at(identifier));
+		m_strings[identifier].clear();
+		m_freeIdentifiers.append(identifier);
+	}
 }
 
-QDateTime HistoryModel::Entry::getTimeVisited() const
+QString HistoryModel::StringsTable::getString(quint32 identifier) const
 {
-	return data(TimeVisitedRole).toDateTime();
+	return m_strings.value(static_cast<int>(identifier));
 }
 
-QIcon HistoryModel::Entry::getIcon() const
+quint32 HistoryModel::StringsTable::insert(const QString &string)
 {
-	const QVariant iconData(data(Qt::DecorationRole));
+	if (string.isEmpty())
+	{
+		return 0;
+	}
+
+	if (m_identifiers.contains(string))
+	{
+		const quint32 identifier(m_identifiers.value(string));
 
-	return (iconData.isNull() ? ThemesManager::createIcon(QLatin1String("text-html")) : iconData.value<QIcon>());
+		++m_references[identifier];
+
+		return identifier;
+	}
+
+	quint32 identifier(0);
+
+	if (m_freeIdentifiers.isEmpty())
+	{
+		identifier = static_cast<quint32>(m_strings.count());
+
+		m_strings.append(string);
+		m_references.append(1);
+	}
+	else
+	{
+		identifier = m_freeIdentifiers.takeLast();
+
+		m_strings[identifier] = string;
+		m_references[identifier] = 1;
+	}
+
+	m_identifiers[string] = identifier;
+
+	return identifier;
 }
 
-quint64 HistoryModel::Entry::getIdentifier() const
+HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *parent) : QAbstractListModel(parent),
+	m_store(new HistoryStore(path, this)),
+	m_lastIdentifier(0),
+	m_type(type),
+	m_isCompletionIndexReady(false),
+	m_isLoading(true),
+	m_needsCompaction(false)
 {
-	return data(IdentifierRole).toULongLong();
+	const bool hasStore(m_store->load([&](const HistoryStore::Record &record)
+	{
+		applyRecord(record);
+	}));
+
+	if (!hasStore)
+	{
+		const QFileInfo fileInformation(path);
+		const QString legacyPath(fileInformation.dir().filePath(fileInformation.completeBaseName() + QLatin1String(".json")));
+
+		if (QFile::exists(legacyPath))
+		{
+			importEntries(legacyPath);
+
+			m_needsCompaction = true;
+		}
+	}
+
+	m_isLoading = false;
+
+	sortEntries();
+
+	connect(FaviconsManager::getInstance(), &FaviconsManager::iconChanged, this, &HistoryModel::handleIconChanged);
+
+	if (m_needsCompaction)
+	{
+		m_needsCompaction = false;
+
+		m_store->compact(createRecords());
+	}
 }
 
-HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *parent) : QStandardItemModel(parent),
-	m_type(type)
+void HistoryModel::importEntries(const QString &path)
 {
 	QFile file(path);
 
@@ -100,148 +188,498 @@ HistoryModel::HistoryModel(const QString &path, HistoryType type, QObject *paren
 		QDateTime dateTime(QDateTime::fromString(entryObject.value(QLatin1String("time")).toString(), Qt::ISODate));
 		dateTime.setTimeSpec(Qt::UTC);
 
-		addEntry(QUrl(entryObject.value(QLatin1String("url")).toString()), entryObject.value(QLatin1String("title")).toString(), {}, dateTime);
+		addEntry(QUrl(entryObject.value(QLatin1String("url")).toString()), entryObject.value(QLatin1String("title")).toString(), dateTime);
 	}
+}
+
+void HistoryModel::applyRecord(const HistoryStore::Record &record)
+{
+	switch (record.type)
+	{
+		case HistoryStore::AddRecord:
+			addEntry(QUrl(record.url), record.title, QDateTime::fromMSecsSinceEpoch(record.timeVisited, Qt::UTC), record.identifier);
+
+			break;
+		case HistoryStore::UpdateRecord:
+			if (updateEntry(record.identifier, QUrl(record.url), record.title))
+			{
+				m_timesColumn[m_slots.value(record.identifier)] = record.timeVisited;
+			}
+
+			break;
+		case HistoryStore::RemoveRecord:
+			removeEntry(record.identifier);
+
+			break;
+		case HistoryStore::ClearRecord:
+			clearEntries();
+
+			break;
+		default:
+			break;
+	}
+}
 
-	setSortRole(TimeVisitedRole);
-	sort(0, Qt::DescendingOrder);
+void HistoryModel::clearEntries()
+{
+	beginResetModel();
+
+	m_urlsTable.clear();
+	m_titlesTable.clear();
+	m_identifiersColumn.clear();
+	m_timesColumn.clear();
+	m_urlsColumn.clear();
+	m_titlesColumn.clear();
+	m_freeSlots.clear();
+	m_order.clear();
+	m_slots.clear();
+	m_urls.clear();
+	m_completionIndex.clear();
+	m_completionKeys.clear();
+
+	endResetModel();
 }
 
-void HistoryModel::clearExcessEntries(int limit)
+void HistoryModel::sortEntries()
+{
+	beginResetModel();
+
+	m_order.clear();
+	m_order.reserve(m_slots.count());
+
+	QHash<quint64, int>::const_iterator iterator;
+
+	for (iterator = m_slots.constBegin(); iterator != m_slots.constEnd(); ++iterator)
+	{
+		m_order.append(iterator.value());
+	}
+
+	std::sort(m_order.begin(), m_order.end(), [&](int first, int second)
+	{
+		return compareSlots(first, second);
+	});
+
+	endResetModel();
+}
+
+void HistoryModel::insertSlot(int slot)
+{
+	const int position(static_cast<int>(std::upper_bound(m_order.constBegin(), m_order.constEnd(), slot, [&](int first, int second)
+	{
+		return compareSlots(first, second);
+	}) - m_order.constBegin()));
+	const int row(m_order.count() - position);
+
+	beginInsertRows({}, row, row);
+
+	m_order.insert(position, slot);
+
+	endInsertRows();
+}
+
+void HistoryModel::releaseSlot(int slot)
 {
-	if (limit > 0 && rowCount() > limit)
+	const QUrl url(Utils::normalizeUrl(getSlotUrl(slot)));
+
+	if (m_urls.contains(url))
 	{
-		for (int i = (rowCount() - 1); i >= limit; --i)
+		m_urls[url].removeAll(slot);
+
+		if (m_urls[url].isEmpty())
 		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
+			m_urls.remove(url);
+
+			removeCompletionKeys(url);
 		}
 	}
+
+	m_urlsTable.release(m_urlsColumn.at(slot));
+	m_titlesTable.release(m_titlesColumn.at(slot));
+	m_slots.remove(m_identifiersColumn.at(slot));
+
+	m_identifiersColumn[slot] = 0;
+	m_timesColumn[slot] = 0;
+	m_urlsColumn[slot] = 0;
+	m_titlesColumn[slot] = 0;
+
+	m_freeSlots.append(slot);
 }
 
-void HistoryModel::clearRecentEntries(uint period)
+void HistoryModel::setSlotUrl(int slot, const QUrl &url)
 {
-	if (period == 0)
+	const QUrl oldUrl(Utils::normalizeUrl(getSlotUrl(slot)));
+	const QUrl newUrl(Utils::normalizeUrl(url));
+
+	if (!oldUrl.isEmpty() && m_urls.contains(oldUrl))
 	{
-		clear();
+		m_urls[oldUrl].removeAll(slot);
 
-		m_urls.clear();
-		m_identifiers.clear();
+		if (m_urls[oldUrl].isEmpty())
+		{
+			m_urls.remove(oldUrl);
 
-		emit cleared();
+			removeCompletionKeys(oldUrl);
+		}
+		else if (oldUrl != newUrl && !getSlotTitle(slot).isEmpty())
+		{
+			updateCompletionKeys(oldUrl);
+		}
+	}
 
+	m_urlsTable.release(m_urlsColumn.at(slot));
+
+	m_urlsColumn[slot] = m_urlsTable.insert(url.toString());
+
+	if (!newUrl.isEmpty())
+	{
+		m_urls[newUrl].append(slot);
+
+		addCompletionKeys(newUrl, getSlotTitle(slot));
+	}
+}
+
+void HistoryModel::setSlotTitle(int slot, const QString &title)
+{
+	const QStringList oldTokens(createTitleTokens(getSlotTitle(slot)));
+	const QStringList tokens(createTitleTokens(title));
+	const QUrl url(Utils::normalizeUrl(getSlotUrl(slot)));
+
+	m_titlesTable.release(m_titlesColumn.at(slot));
+
+	m_titlesColumn[slot] = m_titlesTable.insert(title);
+
+	for (int i = 0; i < oldTokens.count(); ++i)
+	{
+		if (!tokens.contains(oldTokens.at(i)))
+		{
+			updateCompletionKeys(url);
+
+			return;
+		}
+	}
+
+	addCompletionKeys(url, title);
+}
+
+void HistoryModel::addCompletionKey(const QString &key, const QUrl &url, CompletionMatchType type) const
+{
+	if (key.isEmpty())
+	{
+		return;
+	}
+
+	QStringList &keys(m_completionKeys[url]);
+
+	if (!keys.contains(key))
+	{
+		CompletionIndexEntry entry;
+		entry.url = url;
+		entry.type = type;
+
+		keys.append(key);
+
+		m_completionIndex.insert(key, entry);
+	}
+}
+
+void HistoryModel::addCompletionKeys(const QUrl &url, const QString &title) const
+{
+	if (!m_isCompletionIndexReady || url.isEmpty())
+	{
 		return;
 	}
 
-	for (int i = (rowCount() - 1); i >= 0; --i)
+	if (!m_completionKeys.contains(url))
 	{
-		if (index(i, 0).data(TimeVisitedRole).toDateTime().secsTo(QDateTime::currentDateTimeUtc()) < (period * 3600))
+		for (int i = UrlCompletionMatch; i < TitleCompletionMatch; ++i)
 		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
+			const CompletionMatchType type(static_cast<CompletionMatchType>(i));
+
+			addCompletionKey(createCompletionMatch(url, type).toLower(), url, type);
 		}
 	}
+
+	const QStringList tokens(createTitleTokens(title));
+
+	for (int i = 0; i < tokens.count(); ++i)
+	{
+		addCompletionKey(tokens.at(i), url, TitleCompletionMatch);
+	}
 }
 
-void HistoryModel::clearOldestEntries(int period)
+void HistoryModel::removeCompletionKeys(const QUrl &url)
 {
-	if (period < 0)
+	if (!m_isCompletionIndexReady)
 	{
 		return;
 	}
 
-	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	const QStringList keys(m_completionKeys.take(url));
 
-	for (int i = (rowCount() - 1); i >= 0; --i)
+	for (int i = 0; i < keys.count(); ++i)
 	{
-		if (index(i, 0).data(TimeVisitedRole).toDateTime().daysTo(currentDateTime) > period)
+		QMultiMap<QString, CompletionIndexEntry>::iterator iterator(m_completionIndex.lowerBound(keys.at(i)));
+
+		while (iterator != m_completionIndex.end() && iterator.key() == keys.at(i))
 		{
-			removeEntry(index(i, 0).data(IdentifierRole).toULongLong());
+			if (iterator.value().url == url)
+			{
+				iterator = m_completionIndex.erase(iterator);
+			}
+			else
+			{
+				++iterator;
+			}
 		}
 	}
 }
 
-void HistoryModel::removeEntry(quint64 identifier)
+void HistoryModel::updateCompletionKeys(const QUrl &url)
 {
-	Entry *entry(getEntry(identifier));
+	if (!m_isCompletionIndexReady || url.isEmpty())
+	{
+		return;
+	}
+
+	removeCompletionKeys(url);
 
-	if (!entry)
+	const QVector<int> entrySlots(m_urls.value(url));
+
+	for (int i = 0; i < entrySlots.count(); ++i)
+	{
+		addCompletionKeys(url, getSlotTitle(entrySlots.at(i)));
+	}
+}
+
+void HistoryModel::updateCompletionIndex() const
+{
+	if (m_isCompletionIndexReady)
 	{
 		return;
 	}
 
-	const QUrl url(Utils::normalizeUrl(entry->getUrl()));
+	m_isCompletionIndexReady = true;
 
-	if (m_urls.contains(url))
+	QHash<QUrl, QVector<int> >::const_iterator iterator;
+
+	for (iterator = m_urls.constBegin(); iterator != m_urls.constEnd(); ++iterator)
 	{
-		m_urls[url].removeAll(entry);
+		const QVector<int> entrySlots(iterator.value());
 
-		if (m_urls[url].isEmpty())
+		for (int i = 0; i < entrySlots.count(); ++i)
 		{
-			m_urls.remove(url);
+			addCompletionKeys(iterator.key(), getSlotTitle(entrySlots.at(i)));
 		}
 	}
+}
 
-	if (identifier > 0 && m_identifiers.contains(identifier))
+void HistoryModel::clearExcessEntries(int limit)
+{
+	if (limit > 0 && m_order.count() > limit)
 	{
-		m_identifiers.remove(identifier);
+		QVector<int> positions;
+		positions.reserve(m_order.count() - limit);
+
+		for (int i = 0; i < (m_order.count() - limit); ++i)
+		{
+			positions.append(i);
+		}
+
+		removePositions(positions);
 	}
+}
+
+void HistoryModel::clearRecentEntries(uint period)
+{
+	m_needsCompaction = true;
 
-	emit entryRemoved(entry);
+	if (period == 0)
+	{
+		HistoryStore::Record record;
+		record.type = HistoryStore::ClearRecord;
 
-	removeRow(entry->row());
+		m_store->addRecord(record);
 
-	emit modelModified();
+		clearEntries();
+
+		emit cleared();
+
+		return;
+	}
+
+	const qint64 limit(QDateTime::currentMSecsSinceEpoch() - (static_cast<qint64>(period) * 3600000));
+	const int position(static_cast<int>(std::upper_bound(m_order.constBegin(), m_order.constEnd(), limit, [&](qint64 time, int slot)
+	{
+		return (time < m_timesColumn.at(slot));
+	}) - m_order.constBegin()));
+	QVector<int> positions;
+	positions.reserve(m_order.count() - position);
+
+	for (int i = position; i < m_order.count(); ++i)
+	{
+		positions.append(i);
+	}
+
+	removePositions(positions);
 }
 
-HistoryModel::Entry* HistoryModel::addEntry(const QUrl &url, const QString &title, const QIcon &icon, const QDateTime &date, quint64 identifier)
+void HistoryModel::clearOldestEntries(int period)
 {
-	blockSignals(true);
+	if (period < 0)
+	{
+		return;
+	}
 
-	if (m_type == TypedHistory)
+	const qint64 limit(QDateTime(QDateTime::currentDateTimeUtc().date().addDays(-period), QTime(0, 0), Qt::UTC).toMSecsSinceEpoch());
+	const int amount(static_cast<int>(std::lower_bound(m_order.constBegin(), m_order.constEnd(), limit, [&](int slot, qint64 time)
 	{
-		if (hasEntry(url))
+		return (m_timesColumn.at(slot) < time);
+	}) - m_order.constBegin()));
+	QVector<int> positions;
+	positions.reserve(amount);
+
+	for (int i = 0; i < amount; ++i)
+	{
+		positions.append(i);
+	}
+
+	removePositions(positions);
+}
+
+void HistoryModel::removeEntry(quint64 identifier)
+{
+	removeEntries({identifier});
+}
+
+void HistoryModel::removeEntries(const QVector<quint64> &identifiers)
+{
+	QVector<int> positions;
+	positions.reserve(identifiers.count());
+
+	for (int i = 0; i < identifiers.count(); ++i)
+	{
+		const int slot(m_slots.value(identifiers.at(i), -1));
+
+		if (slot >= 0 && m_isLoading)
 		{
-			const QUrl normalizedUrl(Utils::normalizeUrl(url));
+			releaseSlot(slot);
 
-			for (int i = 0; i < m_urls[normalizedUrl].count(); ++i)
-			{
-				removeEntry(m_urls[normalizedUrl].at(i)->getIdentifier());
-			}
+			continue;
 		}
+
+		const int position((slot < 0) ? -1 : getPosition(slot));
+
+		if (position >= 0)
+		{
+			positions.append(position);
+		}
+	}
+
+	removePositions(positions);
+}
+
+void HistoryModel::removePositions(QVector<int> positions)
+{
+	if (positions.isEmpty())
+	{
+		return;
 	}
 
-	Entry *entry(new Entry());
-	entry->setIcon(icon);
+	std::sort(positions.begin(), positions.end());
+
+	positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
 
-	insertRow(0, entry);
-	setData(entry->index(), url, UrlRole);
-	setData(entry->index(), title, TitleRole);
-	setData(entry->index(), date, TimeVisitedRole);
+	QVector<quint64> identifiers;
+	identifiers.reserve(positions.count());
 
-	if (identifier == 0 || m_identifiers.contains(identifier))
+	for (int i = 0; i < positions.count(); ++i)
 	{
-		identifier = (m_identifiers.isEmpty() ? 1 : (m_identifiers.lastKey() + 1));
+		HistoryStore::Record record;
+		record.identifier = m_identifiersColumn.at(m_order.at(positions.at(i)));
+		record.type = HistoryStore::RemoveRecord;
+
+		m_store->addRecord(record);
+
+		identifiers.append(record.identifier);
 	}
 
-	setData(entry->index(), identifier, IdentifierRole);
+	emit entriesRemoved(identifiers);
+
+	int last(positions.count() - 1);
+
+	while (last >= 0)
+	{
+		int first(last);
+
+		while (first > 0 && positions.at(first - 1) == (positions.at(first) - 1))
+		{
+			--first;
+		}
+
+		const int position(positions.at(first));
+		const int amount(last - first + 1);
+		const int row(m_order.count() - position - amount);
+		const QVector<int> removedSlots(m_order.mid(position, amount));
+
+		beginRemoveRows({}, row, (row + amount - 1));
+
+		m_order.remove(position, amount);
+
+		endRemoveRows();
 
-	m_identifiers[identifier] = entry;
+		for (int i = 0; i < removedSlots.count(); ++i)
+		{
+			releaseSlot(removedSlots.at(i));
+		}
 
-	blockSignals(false);
+		last = (first - 1);
+	}
 
-	emit entryAdded(entry);
 	emit modelModified();
+}
 
-	return entry;
+HistoryModel::Entry HistoryModel::getEntry(quint64 identifier) const
+{
+	const int slot(m_slots.value(identifier, -1));
+
+	return ((slot < 0) ? Entry() : createEntry(slot));
 }
 
-HistoryModel::Entry* HistoryModel::getEntry(quint64 identifier) const
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
 {
-	if (m_identifiers.contains(identifier))
+	if (!index.isValid() || index.column() != 0 || index.row() < 0 || index.row() >= m_order.count())
 	{
-		return m_identifiers[identifier];
+		return {};
+	}
+
+	const int slot(getSlot(index.row()));
+
+	switch (role)
+	{
+		case TitleRole:
+			return getSlotTitle(slot);
+		case UrlRole:
+			return getSlotUrl(slot);
+		case IdentifierRole:
+			return m_identifiersColumn.at(slot);
+		case TimeVisitedRole:
+			return QDateTime::fromMSecsSinceEpoch(m_timesColumn.at(slot), Qt::UTC);
+		case Qt::DecorationRole:
+			{
+				const QIcon icon(FaviconsManager::getIcon(getSlotUrl(slot)));
+
+				if (!icon.isNull())
+				{
+					return icon;
+				}
+			}
+
+			break;
+		default:
+			break;
 	}
 
-	return nullptr;
+	return {};
 }
 
 QDateTime HistoryModel::getLastVisitTime(const QUrl &url) const
@@ -253,68 +691,186 @@ QDateTime HistoryModel::getLastVisitTime(const QUrl &url) const
 		return {};
 	}
 
-	const QVector<Entry*> entries(m_urls.value(normalizedUrl));
-	QDateTime lastVisitTime;
+	const QVector<int> entrySlots(m_urls.value(normalizedUrl));
+	qint64 lastVisitTime(m_timesColumn.at(entrySlots.first()));
+
+	for (int i = 1; i < entrySlots.count(); ++i)
+	{
+		lastVisitTime = qMax(lastVisitTime, m_timesColumn.at(entrySlots.at(i)));
+	}
+
+	return QDateTime::fromMSecsSinceEpoch(lastVisitTime, Qt::UTC);
+}
 
-	for (int i = 0; i < entries.count(); ++i)
+void HistoryModel::addRankedMatch(QVector<RankedMatch> &rankedMatches, QHash<QUrl, int> &matchedUrls, const QUrl &url, CompletionMatchType type, const QDateTime &currentDateTime, bool markAsTypedIn) const
+{
+	if (matchedUrls.contains(url))
 	{
-		const QDateTime entryLastVisitTime(entries.at(i)->getTimeVisited());
+		RankedMatch &rankedMatch(rankedMatches[matchedUrls[url]]);
 
-		if (!lastVisitTime.isValid() || entryLastVisitTime > lastVisitTime)
+		if (type < rankedMatch.type)
 		{
-			lastVisitTime = entryLastVisitTime;
+			rankedMatch.match.match = createCompletionMatch(url, type);
+			rankedMatch.type = type;
 		}
+
+		return;
 	}
 
-	return lastVisitTime;
+	const QVector<int> entrySlots(m_urls.value(url));
+
+	if (entrySlots.isEmpty())
+	{
+		return;
+	}
+
+	RankedMatch rankedMatch;
+	rankedMatch.match.match = createCompletionMatch(url, type);
+	rankedMatch.match.isTypedIn = markAsTypedIn;
+	rankedMatch.type = type;
+	rankedMatch.frecency = calculateFrecency(entrySlots, currentDateTime);
+
+	for (int i = 0; i < entrySlots.count(); ++i)
+	{
+		const qint64 timeVisited(m_timesColumn.at(entrySlots.at(i)));
+
+		if (rankedMatch.slot < 0 || timeVisited > rankedMatch.timeVisited)
+		{
+			rankedMatch.slot = entrySlots.at(i);
+			rankedMatch.timeVisited = timeVisited;
+		}
+	}
+
+	matchedUrls[url] = rankedMatches.count();
+
+	rankedMatches.append(rankedMatch);
 }
 
 QVector<HistoryModel::HistoryEntryMatch> HistoryModel::findEntries(const QString &prefix, bool markAsTypedIn) const
 {
-	QVector<Entry*> matchedEntries;
-	QVector<HistoryEntryMatch> allMatches;
-	QVector<HistoryEntryMatch> currentMatches;
-	QMultiMap<QDateTime, HistoryEntryMatch> matchesMap;
-	QHash<QUrl, QVector<Entry*> >::const_iterator urlsIterator;
+	const QDateTime currentDateTime(QDateTime::currentDateTimeUtc());
+	QVector<RankedMatch> rankedMatches;
+	QHash<QUrl, int> matchedUrls;
 
-	for (urlsIterator = m_urls.constBegin(); urlsIterator != m_urls.constEnd(); ++urlsIterator)
+	if (prefix.isEmpty())
 	{
-		if (urlsIterator.value().isEmpty() || matchedEntries.contains(urlsIterator.value().value(0)))
+		QHash<QUrl, QVector<int> >::const_iterator iterator;
+
+		for (iterator = m_urls.constBegin(); iterator != m_urls.constEnd(); ++iterator)
 		{
-			continue;
+			addRankedMatch(rankedMatches, matchedUrls, iterator.key(), UrlCompletionMatch, currentDateTime, markAsTypedIn);
 		}
+	}
+	else
+	{
+		updateCompletionIndex();
 
-		const QString result(Utils::matchUrl(urlsIterator.key(), prefix));
+		const QString key(prefix.toLower());
+		QMultiMap<QString, CompletionIndexEntry>::const_iterator iterator(m_completionIndex.lowerBound(key));
 
-		if (!result.isEmpty())
+		while (iterator != m_completionIndex.constEnd() && iterator.key().startsWith(key))
 		{
-			HistoryEntryMatch match;
-			match.entry = urlsIterator.value().value(0);
-			match.match = result;
+			addRankedMatch(rankedMatches, matchedUrls, iterator.value().url, iterator.value().type, currentDateTime, markAsTypedIn);
 
-			if (markAsTypedIn)
-			{
-				match.isTypedIn = true;
-			}
+			++iterator;
+		}
+	}
+
+	std::sort(rankedMatches.begin(), rankedMatches.end(), [&](const RankedMatch &first, const RankedMatch &second)
+	{
+		const bool isFirstTitleMatch(first.type == TitleCompletionMatch);
+		const bool isSecondTitleMatch(second.type == TitleCompletionMatch);
 
-			matchesMap.insert(match.entry->data(TimeVisitedRole).toDateTime(), match);
+		if (isFirstTitleMatch != isSecondTitleMatch)
+		{
+			return isSecondTitleMatch;
+		}
 
-			matchedEntries.append(match.entry);
+		if (first.frecency != second.frecency)
+		{
+			return (first.frecency > second.frecency);
 		}
+
+		return (first.timeVisited > second.timeVisited);
+	});
+
+	QVector<HistoryEntryMatch> matches;
+	matches.reserve(rankedMatches.count());
+
+	for (int i = 0; i < rankedMatches.count(); ++i)
+	{
+		HistoryEntryMatch match(rankedMatches.at(i).match);
+		match.entry = createEntry(rankedMatches.at(i).slot);
+
+		matches.append(match);
 	}
 
-	currentMatches = matchesMap.values().toVector();
+	return matches;
+}
+
+QString HistoryModel::createCompletionMatch(const QUrl &url, CompletionMatchType type)
+{
+	switch (type)
+	{
+		case UrlCompletionMatch:
+			return url.toString();
+		case SchemelessUrlCompletionMatch:
+			return url.toString(QUrl::RemoveScheme).mid(2);
+		case WwwlessUrlCompletionMatch:
+			{
+				const QString match(url.toString(QUrl::RemoveScheme).mid(2));
+
+				if (match.startsWith(QLatin1String("www.")) && url.host().count(QLatin1Char('.')) > 1)
+				{
+					return match.mid(4);
+				}
+			}
 
-	matchesMap.clear();
+			break;
+		default:
+			break;
+	}
 
-	allMatches.reserve(currentMatches.count());
+	return {};
+}
 
-	for (int i = (currentMatches.count() - 1); i >= 0; --i)
+QString HistoryModel::getSlotTitle(int slot) const
+{
+	return m_titlesTable.getString(m_titlesColumn.at(slot));
+}
+
+QStringList HistoryModel::createTitleTokens(const QString &title)
+{
+	static const QRegularExpression expression(QLatin1String("[\\W_]+"), QRegularExpression::UseUnicodePropertiesOption);
+	const QStringList words(title.toLower().split(expression, QString::SkipEmptyParts));
+	QStringList tokens;
+	tokens.reserve(words.count());
+
+	for (int i = 0; i < words.count(); ++i)
 	{
-		allMatches.append(currentMatches.at(i));
+		if (words.at(i).length() > 1 && !tokens.contains(words.at(i)))
+		{
+			tokens.append(words.at(i));
+		}
 	}
 
-	return allMatches;
+	return tokens;
+}
+
+QUrl HistoryModel::getSlotUrl(int slot) const
+{
+	return QUrl(m_urlsTable.getString(m_urlsColumn.at(slot)));
+}
+
+HistoryModel::Entry HistoryModel::createEntry(int slot) const
+{
+	Entry entry;
+	entry.url = getSlotUrl(slot);
+	entry.title = getSlotTitle(slot);
+	entry.timeVisited = QDateTime::fromMSecsSinceEpoch(m_timesColumn.at(slot), Qt::UTC);
+	entry.identifier = m_identifiersColumn.at(slot);
+
+	return entry;
 }
 
 HistoryModel::HistoryType HistoryModel::getType() const
@@ -322,88 +878,236 @@ HistoryModel::HistoryType HistoryModel::getType() const
 	return m_type;
 }
 
-bool HistoryModel::save(const QString &path) const
+HistoryStore::Record HistoryModel::createRecord(int slot, HistoryStore::RecordType type) const
 {
-	if (SessionsManager::isReadOnly())
+	HistoryStore::Record record;
+	record.url = m_urlsTable.getString(m_urlsColumn.at(slot));
+	record.title = getSlotTitle(slot);
+	record.timeVisited = m_timesColumn.at(slot);
+	record.identifier = m_identifiersColumn.at(slot);
+	record.type = type;
+
+	return record;
+}
+
+QVector<HistoryStore::Record> HistoryModel::createRecords() const
+{
+	QVector<HistoryStore::Record> records;
+	records.reserve(m_order.count());
+
+	for (int i = 0; i < m_order.count(); ++i)
 	{
-		return false;
+		records.append(createRecord(m_order.at(i), HistoryStore::AddRecord));
 	}
 
-	QJsonArray historyArray;
+	return records;
+}
 
-	for (int i = 0; i < rowCount(); ++i)
+quint64 HistoryModel::addEntry(const QUrl &url, const QString &title, const QDateTime &date, quint64 identifier)
+{
+	if (m_type == TypedHistory && hasEntry(url))
 	{
-		const QModelIndex index(this->index(i, 0));
+		const QVector<int> entrySlots(m_urls.value(Utils::normalizeUrl(url)));
+		QVector<quint64> identifiers;
+		identifiers.reserve(entrySlots.count());
 
-		if (index.isValid())
+		for (int i = 0; i < entrySlots.count(); ++i)
 		{
-			historyArray.prepend(QJsonObject({{QLatin1String("url"), index.data(UrlRole).toUrl().toString()}, {QLatin1String("title"), index.data(TitleRole).toString()}, {QLatin1String("time"), index.data(TimeVisitedRole).toDateTime().toString(Qt::ISODate)}}));
+			identifiers.append(m_identifiersColumn.at(entrySlots.at(i)));
 		}
+
+		removeEntries(identifiers);
+	}
+
+	if (identifier == 0 || m_slots.contains(identifier))
+	{
+		identifier = (m_lastIdentifier + 1);
 	}
 
-	JsonSettings settings;
-	settings.setArray(historyArray);
+	m_lastIdentifier = qMax(m_lastIdentifier, identifier);
 
-	return settings.save(path);
+	const int slot(allocateSlot());
+
+	m_identifiersColumn[slot] = identifier;
+	m_timesColumn[slot] = date.toMSecsSinceEpoch();
+	m_titlesColumn[slot] = m_titlesTable.insert(title);
+	m_slots[identifier] = slot;
+
+	setSlotUrl(slot, url);
+
+	if (m_isLoading)
+	{
+		return identifier;
+	}
+
+	insertSlot(slot);
+
+	m_store->addRecord(createRecord(slot, HistoryStore::AddRecord));
+
+	emit entryAdded(createEntry(slot));
+	emit modelModified();
+
+	return identifier;
 }
 
-bool HistoryModel::setData(const QModelIndex &index, const QVariant &value, int role)
+int HistoryModel::allocateSlot()
 {
-	Entry *entry(static_cast<Entry*>(itemFromIndex(index)));
-
-	if (!entry)
+	if (!m_freeSlots.isEmpty())
 	{
-		return QStandardItemModel::setData(index, value, role);
+		return m_freeSlots.takeLast();
 	}
 
-	if (role == UrlRole && value.toUrl() != index.data(UrlRole).toUrl())
+	m_identifiersColumn.append(0);
+	m_timesColumn.append(0);
+	m_urlsColumn.append(0);
+	m_titlesColumn.append(0);
+
+	return (m_identifiersColumn.count() - 1);
+}
+
+int HistoryModel::getSlot(int row) const
+{
+	return m_order.at(m_order.count() - row - 1);
+}
+
+int HistoryModel::getPosition(int slot) const
+{
+	const QVector<int>::const_iterator iterator(std::lower_bound(m_order.constBegin(), m_order.constEnd(), slot, [&](int first, int second)
 	{
-		const QUrl oldUrl(Utils::normalizeUrl(index.data(UrlRole).toUrl()));
-		const QUrl newUrl(Utils::normalizeUrl(value.toUrl()));
+		return compareSlots(first, second);
+	}));
 
-		if (!oldUrl.isEmpty() && m_urls.contains(oldUrl))
-		{
-			m_urls[oldUrl].removeAll(entry);
+	return ((iterator != m_order.constEnd() && *iterator == slot) ? static_cast<int>(iterator - m_order.constBegin()) : -1);
+}
 
-			if (m_urls[oldUrl].isEmpty())
-			{
-				m_urls.remove(oldUrl);
-			}
-		}
+int HistoryModel::calculateFrecency(const QVector<int> &entrySlots, const QDateTime &currentDateTime) const
+{
+	int frecency(0);
 
-		if (!newUrl.isEmpty())
-		{
-			if (!m_urls.contains(newUrl))
-			{
-				m_urls[newUrl] = QVector<Entry*>();
-			}
+	for (int i = 0; i < entrySlots.count(); ++i)
+	{
+		const qint64 age(QDateTime::fromMSecsSinceEpoch(m_timesColumn.at(entrySlots.at(i)), Qt::UTC).daysTo(currentDateTime));
 
-			m_urls[newUrl].append(entry);
+		if (age <= 4)
+		{
+			frecency += 100;
+		}
+		else if (age <= 14)
+		{
+			frecency += 70;
+		}
+		else if (age <= 31)
+		{
+			frecency += 50;
+		}
+		else if (age <= 90)
+		{
+			frecency += 30;
+		}
+		else
+		{
+			frecency += 10;
 		}
 	}
 
-	entry->setItemData(value, role);
+	return frecency;
+}
 
-	switch (role)
+int HistoryModel::rowCount(const QModelIndex &index) const
+{
+	return (index.isValid() ? 0 : m_order.count());
+}
+
+bool HistoryModel::compareSlots(int first, int second) const
+{
+	if (m_timesColumn.at(first) != m_timesColumn.at(second))
 	{
-		case TitleRole:
-		case UrlRole:
-		case IdentifierRole:
-		case TimeVisitedRole:
-			emit entryModified(entry);
-			emit modelModified();
+		return (m_timesColumn.at(first) < m_timesColumn.at(second));
+	}
 
-			break;
-		default:
-			break;
+	return (m_identifiersColumn.at(first) < m_identifiersColumn.at(second));
+}
+
+bool HistoryModel::updateEntry(quint64 identifier, const QUrl &url, const QString &title)
+{
+	const int slot(m_slots.value(identifier, -1));
+
+	if (slot < 0)
+	{
+		return false;
+	}
+
+	if (url != getSlotUrl(slot))
+	{
+		setSlotUrl(slot, url);
+	}
+
+	if (title != getSlotTitle(slot))
+	{
+		setSlotTitle(slot, title);
 	}
 
+	if (m_isLoading)
+	{
+		return true;
+	}
+
+	m_store->addRecord(createRecord(slot, HistoryStore::UpdateRecord));
+
+	const int position(getPosition(slot));
+
+	if (position >= 0)
+	{
+		const QModelIndex entryIndex(index(m_order.count() - position - 1, 0));
+
+		emit dataChanged(entryIndex, entryIndex);
+	}
+
+	emit entryModified(createEntry(slot));
+	emit modelModified();
+
 	return true;
 }
 
+void HistoryModel::handleIconChanged(const QUrl &url)
+{
+	const QVector<int> entrySlots(m_urls.value(Utils::normalizeUrl(url)));
+
+	for (int i = 0; i < entrySlots.count(); ++i)
+	{
+		const int position(getPosition(entrySlots.at(i)));
+
+		if (position >= 0)
+		{
+			const QModelIndex entryIndex(index(m_order.count() - position - 1, 0));
+
+			emit dataChanged(entryIndex, entryIndex, {Qt::DecorationRole});
+		}
+	}
+}
+
 bool HistoryModel::hasEntry(const QUrl &url) const
 {
 	return m_urls.contains(Utils::normalizeUrl(url));
 }
 
+bool HistoryModel::save()
+{
+	if (SessionsManager::isReadOnly())
+	{
+		return false;
+	}
+
+	if ((m_needsCompaction || m_store->needsCompaction(rowCount())) && !m_store->isCompacting())
+	{
+		m_needsCompaction = false;
+
+		m_store->compact(createRecords());
+
+		return true;
+	}
+
+	return m_store->flush();
+}
+
 }
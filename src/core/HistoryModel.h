@@ -17,18 +17,20 @@
 * along with this program. If not, see <http://www.gnu.org/licenses/>.
 *
 **************************************************************************/
-
 #ifndef OTTER_HISTORYMODEL_H
 #define OTTER_HISTORYMODEL_H
 
+#include "HistoryStore.h"
+
+#include <QtCore/QAbstractListModel>
 #include <QtCore/QDateTime>
 #include <QtCore/QUrl>
-#include <QtGui/QStandardItemModel>
+#include <QtGui/QIcon>
 
 namespace Otter
 {
 
-class HistoryModel final : public QStandardItemModel
+class HistoryModel final : public QAbstractListModel
 {
 	Q_OBJECT
 
@@ -47,26 +49,21 @@ public:
 		TypedHistory
 	};
 
-	class Entry final : public QStandardItem
+	struct Entry final
 	{
-	public:
-		void setData(const QVariant &value, int role) override;
-		void setItemData(const QVariant &value, int role);
+		QUrl url;
+		QString title;
+		QDateTime timeVisited;
+		quint64 identifier = 0;
+
 		QString getTitle() const;
-		QUrl getUrl() const;
-		QDateTime getTimeVisited() const;
 		QIcon getIcon() const;
-		quint64 getIdentifier() const;
-
-	protected:
-		explicit Entry();
-
-	friend class HistoryModel;
+		bool isValid() const;
 	};
 
 	struct HistoryEntryMatch final
 	{
-		Entry *entry = nullptr;
+		Entry entry;
 		QString match;
 		bool isTypedIn = false;
 	};
@@ -77,25 +74,116 @@ public:
 	void clearRecentEntries(uint period);
 	void clearOldestEntries(int period);
 	void removeEntry(quint64 identifier);
-	Entry* addEntry(const QUrl &url, const QString &title, const QIcon &icon, const QDateTime &date = QDateTime::currentDateTimeUtc(), quint64 identifier = 0);
-	Entry* getEntry(quint64 identifier) const;
+	void removeEntries(const QVector<quint64> &identifiers);
+	Entry getEntry(quint64 identifier) const;
+	QVariant data(const QModelIndex &index, int role) const override;
 	QDateTime getLastVisitTime(const QUrl &url) const;
 	QVector<HistoryEntryMatch> findEntries(const QString &prefix, bool markAsTypedIn = false) const;
 	HistoryType getType() const;
+	quint64 addEntry(const QUrl &url, const QString &title, const QDateTime &date = QDateTime::currentDateTimeUtc(), quint64 identifier = 0);
+	int rowCount(const QModelIndex &index = {}) const override;
+	bool updateEntry(quint64 identifier, const QUrl &url, const QString &title);
 	bool hasEntry(const QUrl &url) const;
-	bool save(const QString &path) const;
-	bool setData(const QModelIndex &index, const QVariant &value, int role) override;
+	bool save();
+
+protected:
+	enum CompletionMatchType
+	{
+		UrlCompletionMatch = 0,
+		SchemelessUrlCompletionMatch,
+		WwwlessUrlCompletionMatch,
+		TitleCompletionMatch
+	};
+
+	struct CompletionIndexEntry final
+	{
+		QUrl url;
+		CompletionMatchType type = UrlCompletionMatch;
+	};
+
+	struct RankedMatch final
+	{
+		HistoryEntryMatch match;
+		CompletionMatchType type = UrlCompletionMatch;
+		qint64 timeVisited = 0;
+		int frecency = 0;
+		int slot = -1;
+	};
+
+	class StringsTable final
+	{
+	public:
+		StringsTable();
+
+		void clear();
+		void release(quint32 identifier);
+		QString getString(quint32 identifier) const;
+		quint32 insert(const QString &string);
+
+	private:
+		QVector<QString> m_strings;
+		QVector<quint32> m_references;
+		QVector<quint32> m_freeIdentifiers;
+		QHash<QString, quint32> m_identifiers;
+	};
+
+	void importEntries(const QString &path);
+	void applyRecord(const HistoryStore::Record &record);
+	void clearEntries();
+	void sortEntries();
+	void insertSlot(int slot);
+	void releaseSlot(int slot);
+	void removePositions(QVector<int> positions);
+	void setSlotUrl(int slot, const QUrl &url);
+	void setSlotTitle(int slot, const QString &title);
+	void addCompletionKey(const QString &key, const QUrl &url, CompletionMatchType type) const;
+	void addCompletionKeys(const QUrl &url, const QString &title) const;
+	void removeCompletionKeys(const QUrl &url);
+	void updateCompletionKeys(const QUrl &url);
+	void updateCompletionIndex() const;
+	static QString createCompletionMatch(const QUrl &url, CompletionMatchType type);
+	QString getSlotTitle(int slot) const;
+	static QStringList createTitleTokens(const QString &title);
+	QUrl getSlotUrl(int slot) const;
+	Entry createEntry(int slot) const;
+	HistoryStore::Record createRecord(int slot, HistoryStore::RecordType type) const;
+	QVector<HistoryStore::Record> createRecords() const;
+	int allocateSlot();
+	int getSlot(int row) const;
+	int getPosition(int slot) const;
+	int calculateFrecency(const QVector<int> &entrySlots, const QDateTime &currentDateTime) const;
+	bool compareSlots(int first, int second) const;
+
+protected slots:
+	void handleIconChanged(const QUrl &url);
 
 private:
-	QHash<QUrl, QVector<Entry*> > m_urls;
-	QMap<quint64, Entry*> m_identifiers;
+	void addRankedMatch(QVector<RankedMatch> &rankedMatches, QHash<QUrl, int> &matchedUrls, const QUrl &url, CompletionMatchType type, const QDateTime &currentDateTime, bool markAsTypedIn) const;
+
+	HistoryStore *m_store;
+	StringsTable m_urlsTable;
+	StringsTable m_titlesTable;
+	QVector<quint64> m_identifiersColumn;
+	QVector<qint64> m_timesColumn;
+	QVector<quint32> m_urlsColumn;
+	QVector<quint32> m_titlesColumn;
+	QVector<int> m_freeSlots;
+	QVector<int> m_order;
+	QHash<quint64, int> m_slots;
+	QHash<QUrl, QVector<int> > m_urls;
+	mutable QMultiMap<QString, CompletionIndexEntry> m_completionIndex;
+	mutable QHash<QUrl, QStringList> m_completionKeys;
+	quint64 m_lastIdentifier;
 	HistoryType m_type;
+	mutable bool m_isCompletionIndexReady;
+	bool m_isLoading;
+	bool m_needsCompaction;
 
 signals:
 	void cleared();
-	void entryAdded(Entry *entry);
-	void entryModified(Entry *entry);
-	void entryRemoved(Entry *entry);
+	void entryAdded(const HistoryModel::Entry &entry);
+	void entryModified(const HistoryModel::Entry &entry);
+	void entriesRemoved(const QVector<quint64> &identifiers);
 	void modelModified();
 };
 
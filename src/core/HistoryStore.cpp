@@ -0,0 +1,308 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "HistoryStore.h"
+#include "Console.h"
+#include "SessionsManager.h"
+
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+namespace Otter
+{
+
+HistoryStore::HistoryStore(const QString &path, QObject *parent) : QObject(parent),
+	m_path(path),
+	m_recordsAmount(0),
+	m_compactionAmount(0),
+	m_isCompacting(false),
+	m_isCompactionSuccessful(false)
+{
+}
+
+HistoryStore::~HistoryStore()
+{
+	m_compactionFutures.waitForFinished();
+
+	handleCompactionFinished();
+	flush();
+}
+
+void HistoryStore::addRecord(const Record &record)
+{
+	m_pendingRecords.append(record);
+}
+
+void HistoryStore::compact(const QVector<Record> &entries)
+{
+	if (m_isCompacting || SessionsManager::isReadOnly())
+	{
+		return;
+	}
+
+	const QString path(m_path);
+
+	m_isCompacting = true;
+	m_isCompactionSuccessful = false;
+	m_compactionAmount = entries.count();
+	m_compactedRecords = m_pendingRecords;
+
+	m_pendingRecords.clear();
+
+	m_compactionFutures.addFuture(QtConcurrent::run([=]()
+	{
+		m_isCompactionSuccessful = writeSnapshot(path, entries);
+
+		QMetaObject::invokeMethod(this, "handleCompactionFinished", Qt::QueuedConnection);
+	}));
+}
+
+void HistoryStore::handleCompactionFinished()
+{
+	if (!m_isCompacting)
+	{
+		return;
+	}
+
+	m_isCompacting = false;
+
+	if (m_isCompactionSuccessful)
+	{
+		m_recordsAmount = m_compactionAmount;
+	}
+	else
+	{
+		m_pendingRecords = (m_compactedRecords + m_pendingRecords);
+
+		Console::addMessage(QCoreApplication::translate("main", "Failed to compact history file"), Console::OtherCategory, Console::ErrorLevel, m_path);
+	}
+
+	m_compactedRecords.clear();
+
+	flush();
+}
+
+void HistoryStore::writeHeader(QDataStream &stream)
+{
+	stream << m_magic << m_version;
+}
+
+void HistoryStore::writeRecord(QDataStream &stream, const Record &record)
+{
+	stream << static_cast<quint8>(record.type) << record.identifier;
+
+	if (record.type == AddRecord || record.type == UpdateRecord)
+	{
+		stream << record.url << record.title << record.timeVisited;
+	}
+}
+
+QString HistoryStore::getPath() const
+{
+	return m_path;
+}
+
+bool HistoryStore::load(const std::function<void(const Record &record)> &function)
+{
+	QFile file(m_path);
+
+	if (!file.exists())
+	{
+		return false;
+	}
+
+	if (!file.open(QIODevice::ReadOnly))
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to open history file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		return true;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	quint32 magic(0);
+	quint16 version(0);
+
+	stream >> magic >> version;
+
+	if (magic != m_magic || version > m_version)
+	{
+		file.close();
+
+		Console::addMessage(QCoreApplication::translate("main", "Failed to load history file: unsupported format"), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		if (!SessionsManager::isReadOnly())
+		{
+			QFile::remove(m_path + QLatin1String(".bak"));
+			QFile::rename(m_path, m_path + QLatin1String(".bak"));
+		}
+
+		return false;
+	}
+
+	qint64 position(file.pos());
+	Record record;
+
+	while (!stream.atEnd() && readRecord(stream, record))
+	{
+		function(record);
+
+		position = file.pos();
+
+		++m_recordsAmount;
+	}
+
+	const bool isTruncated(position < file.size());
+
+	file.close();
+
+	if (isTruncated)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "History file was not saved properly, discarding incomplete records"), Console::OtherCategory, Console::WarningLevel, m_path);
+
+		if (!SessionsManager::isReadOnly())
+		{
+			QFile::resize(m_path, position);
+		}
+	}
+
+	return true;
+}
+
+bool HistoryStore::readRecord(QDataStream &stream, Record &record)
+{
+	quint8 type(UnknownRecord);
+
+	stream >> type >> record.identifier;
+
+	record.type = static_cast<RecordType>(type);
+	record.url.clear();
+	record.title.clear();
+	record.timeVisited = 0;
+
+	switch (record.type)
+	{
+		case AddRecord:
+		case UpdateRecord:
+			stream >> record.url >> record.title >> record.timeVisited;
+
+			break;
+		case RemoveRecord:
+		case ClearRecord:
+			break;
+		default:
+			return false;
+	}
+
+	return (stream.status() == QDataStream::Ok);
+}
+
+bool HistoryStore::writeSnapshot(const QString &path, const QVector<Record> &entries)
+{
+	QSaveFile file(path);
+
+	if (!file.open(QIODevice::WriteOnly))
+	{
+		return false;
+	}
+
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	writeHeader(stream);
+
+	for (int i = 0; i < entries.count(); ++i)
+	{
+		writeRecord(stream, entries.at(i));
+	}
+
+	return (stream.status() == QDataStream::Ok && file.commit());
+}
+
+bool HistoryStore::flush()
+{
+	if (m_pendingRecords.isEmpty() || m_isCompacting)
+	{
+		return true;
+	}
+
+	if (SessionsManager::isReadOnly())
+	{
+		m_pendingRecords.clear();
+
+		return false;
+	}
+
+	QFile file(m_path);
+
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to save history file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		return false;
+	}
+
+	const qint64 size(file.size());
+	QDataStream stream(&file);
+	stream.setVersion(QDataStream::Qt_5_0);
+
+	if (size == 0)
+	{
+		writeHeader(stream);
+	}
+
+	for (int i = 0; i < m_pendingRecords.count(); ++i)
+	{
+		writeRecord(stream, m_pendingRecords.at(i));
+	}
+
+	file.close();
+
+	if (stream.status() != QDataStream::Ok || file.error() != QFileDevice::NoError)
+	{
+		Console::addMessage(QCoreApplication::translate("main", "Failed to save history file: %1").arg(file.errorString()), Console::OtherCategory, Console::ErrorLevel, m_path);
+
+		QFile::resize(m_path, size);
+
+		return false;
+	}
+
+	m_recordsAmount += m_pendingRecords.count();
+
+	m_pendingRecords.clear();
+
+	return true;
+}
+
+bool HistoryStore::needsCompaction(int amount) const
+{
+	const int limit(amount * 2);
+
+	return (m_recordsAmount > m_minimumCompactionAmount && m_recordsAmount > limit);
+}
+
+bool HistoryStore::isCompacting() const
+{
+	return m_isCompacting;
+}
+
+}
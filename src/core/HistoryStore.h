@@ -0,0 +1,93 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_HISTORYSTORE_H
+#define OTTER_HISTORYSTORE_H
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QObject>
+#include <QtCore/QVector>
+
+#include <functional>
+
+namespace Otter
+{
+
+class HistoryStore final : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum RecordType
+	{
+		UnknownRecord = 0,
+		AddRecord,
+		UpdateRecord,
+		RemoveRecord,
+		ClearRecord
+	};
+
+	struct Record final
+	{
+		QString url;
+		QString title;
+		qint64 timeVisited = 0;
+		quint64 identifier = 0;
+		RecordType type = UnknownRecord;
+	};
+
+	explicit HistoryStore(const QString &path, QObject *parent = nullptr);
+	~HistoryStore();
+
+	void addRecord(const Record &record);
+	void compact(const QVector<Record> &entries);
+	QString getPath() const;
+	bool load(const std::function<void(const Record &record)> &function);
+	bool flush();
+	bool needsCompaction(int amount) const;
+	bool isCompacting() const;
+
+protected:
+	static void writeHeader(QDataStream &stream);
+	static void writeRecord(QDataStream &stream, const Record &record);
+	static bool readRecord(QDataStream &stream, Record &record);
+	static bool writeSnapshot(const QString &path, const QVector<Record> &entries);
+
+protected slots:
+	void handleCompactionFinished();
+
+private:
+	QString m_path;
+	QVector<Record> m_pendingRecords;
+	QVector<Record> m_compactedRecords;
+	QFutureSynchronizer<void> m_compactionFutures;
+	int m_recordsAmount;
+	int m_compactionAmount;
+	bool m_isCompacting;
+	bool m_isCompactionSuccessful;
+
+	static const quint32 m_magic = 0x4F484A4E;
+	static const quint16 m_version = 1;
+	static const int m_minimumCompactionAmount = 1000;
+};
+
+}
+
+#endif
@@ -274,6 +274,11 @@ public:
 			overrides.endGroup();
 		}
 
+		configuration.sync();
+		overrides.sync();
+
+		SettingsManager::loadOptions();
+
 		const QStringList sessions(SessionsManager::getSessions());
 
 		for (int i = 0; i < sessions.count(); ++i)
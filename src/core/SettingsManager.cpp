@@ -21,14 +21,19 @@
 
 #include "SettingsManager.h"
 
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QMetaEnum>
-#include <QtCore/QSettings>
+#include <QtCore/QSet>
 #include <QtCore/QStandardPaths>
 #include <QtCore/QTextStream>
+#include <QtCore/QTimerEvent>
 #include <QtCore/QVector>
 
+#include <algorithm>
+
 namespace Otter
 {
 
@@ -36,13 +41,53 @@ SettingsManager* SettingsManager::m_instance(nullptr);
 QString SettingsManager::m_globalPath;
 QString SettingsManager::m_overridePath;
 QVector<SettingsManager::OptionDefinition> SettingsManager::m_definitions;
+QVector<QVariant> SettingsManager::m_globalValues;
+QHash<QString, QHash<int, QVariant> > SettingsManager::m_overrideValues;
+QHash<QString, QHash<int, QVariant> > SettingsManager::m_resolvedOverrides;
+QVector<SettingsManager::OverridesNode> SettingsManager::m_overridesNodes;
+QStringList SettingsManager::m_overrideHosts;
 QHash<QString, int> SettingsManager::m_customOptions;
+SettingsManager::OptionAccessCounters SettingsManager::m_accessCounters[SettingsManager::m_accessCountersAmount];
+QReadWriteLock SettingsManager::m_valuesLock;
+QMutex SettingsManager::m_savingMutex;
+QMutex SettingsManager::m_resolvedOverridesMutex;
 int SettingsManager::m_identifierCounter(-1);
 int SettingsManager::m_optionIdentifierEnumerator(0);
-bool SettingsManager::m_hasWildcardedOverrides(false);
+std::atomic<bool> SettingsManager::m_isProfilingEnabled(false);
+thread_local SettingsManager::ProfilingSubsystem SettingsManager::m_profilingSubsystem(SettingsManager::UnknownSubsystem);
+
+SettingsManager::SettingsManager(QObject *parent) : QObject(parent),
+	m_fileSystemWatcher(nullptr),
+	m_saveTimer(0),
+	m_savingAmount(0),
+	m_needsReload(false)
+{
+}
+
+SettingsManager::~SettingsManager()
+{
+	m_savingFutures.waitForFinished();
+
+	if (!m_pendingChanges.isEmpty())
+	{
+		saveOptions(m_pendingChanges);
+	}
+
+	setProfilingEnabled(false);
+	resetAccessStatistics();
+}
 
-SettingsManager::SettingsManager(QObject *parent) : QObject(parent)
+SettingsManager::ProfilingScope::ProfilingScope(ProfilingSubsystem subsystem) : m_previousSubsystem(m_profilingSubsystem)
 {
+	if (m_previousSubsystem == UnknownSubsystem)
+	{
+		m_profilingSubsystem = subsystem;
+	}
+}
+
+SettingsManager::ProfilingScope::~ProfilingScope()
+{
+	m_profilingSubsystem = m_previousSubsystem;
 }
 
 void SettingsManager::createInstance(const QString &path)
@@ -128,6 +173,7 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Content_ZoomTextOnlyOption, BooleanType, false);
 	registerOption(ContentBlocking_EnableContentBlockingOption, BooleanType, true);
 	registerOption(ContentBlocking_IgnoreHostsOption, ListType, QStringList());
+	registerOption(ContentBlocking_PendingRequestsPolicyOption, EnumerationType, QLatin1String("wait"), {QLatin1String("allow"), QLatin1String("wait"), QLatin1String("block")});
 	registerOption(ContentBlocking_ProfilesOption, ListType, QStringList());
 	registerOption(History_BrowsingLimitAmountGlobalOption, IntegerType, 1000);
 	registerOption(History_BrowsingLimitAmountWindowOption, IntegerType, 50);
@@ -246,28 +292,178 @@ void SettingsManager::createInstance(const QString &path)
 	registerOption(Updates_LastCheckOption, StringType, QString());
 	registerOption(Updates_ServerUrlOption, StringType, QLatin1String("https://www.otter-browser.org/updates/update.json"));
 
-	const QStringList hosts(getOverrideHosts());
+	loadOptions();
+
+	m_instance->m_fileSystemWatcher = new QFileSystemWatcher(m_instance);
+	m_instance->updateWatchedPaths();
+
+	connect(m_instance->m_fileSystemWatcher, &QFileSystemWatcher::fileChanged, m_instance, &SettingsManager::handleFileChanged);
+}
+
+void SettingsManager::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() != m_saveTimer)
+	{
+		return;
+	}
+
+	killTimer(m_saveTimer);
+
+	m_saveTimer = 0;
+
+	if (m_pendingChanges.isEmpty())
+	{
+		return;
+	}
+
+	const QVector<OptionChange> changes(m_pendingChanges);
+
+	m_pendingChanges.clear();
+
+	++m_savingAmount;
+
+	m_savingFutures.addFuture(QtConcurrent::run([=]()
+	{
+		saveOptions(changes);
+
+		QMetaObject::invokeMethod(m_instance, "handleOptionsSaved", Qt::QueuedConnection);
+	}));
+}
+
+void SettingsManager::loadOptions()
+{
+	QVector<QVariant> globalValues(m_definitions.count());
+	QSettings globalSettings(m_globalPath, QSettings::IniFormat);
+	const QStringList globalKeys(globalSettings.allKeys());
+
+	for (int i = 0; i < globalKeys.count(); ++i)
+	{
+		const int identifier(getOptionIdentifier(globalKeys.at(i)));
+
+		if (identifier >= 0 && identifier < globalValues.count())
+		{
+			globalValues[identifier] = globalSettings.value(globalKeys.at(i));
+		}
+	}
+
+	QHash<QString, QHash<int, QVariant> > overrideValues;
+	QSettings overrideSettings(m_overridePath, QSettings::IniFormat);
+	const QStringList hosts(overrideSettings.childGroups());
 
 	for (int i = 0; i < hosts.count(); ++i)
 	{
-		if (hosts.at(i).startsWith(QLatin1Char('*')))
+		overrideSettings.beginGroup(hosts.at(i));
+
+		const QStringList keys(overrideSettings.allKeys());
+		QHash<int, QVariant> hostValues;
+
+		for (int j = 0; j < keys.count(); ++j)
 		{
-			m_hasWildcardedOverrides = true;
+			const int identifier(getOptionIdentifier(keys.at(j)));
 
-			break;
+			if (identifier >= 0 && identifier < m_definitions.count())
+			{
+				hostValues[identifier] = overrideSettings.value(keys.at(j));
+			}
+		}
+
+		overrideSettings.endGroup();
+
+		if (!hostValues.isEmpty())
+		{
+			overrideValues[hosts.at(i)] = hostValues;
+		}
+	}
+
+	QVector<QVariant> previousGlobalValues;
+	QHash<QString, QHash<int, QVariant> > previousOverrideValues;
+
+	{
+		QWriteLocker locker(&m_valuesLock);
+
+		previousGlobalValues = m_globalValues;
+		previousOverrideValues = m_overrideValues;
+
+		m_globalValues = globalValues;
+		m_overrideValues = overrideValues;
+
+		if (m_instance)
+		{
+			for (int i = 0; i < m_instance->m_pendingChanges.count(); ++i)
+			{
+				applyOptionChange(m_instance->m_pendingChanges.at(i));
+			}
+		}
+
+		createOverridesIndex();
+	}
+
+	if (previousGlobalValues.isEmpty() || !m_instance)
+	{
+		return;
+	}
+
+	for (int i = 0; i < m_globalValues.count(); ++i)
+	{
+		if (previousGlobalValues.value(i) != m_globalValues.at(i))
+		{
+			emit m_instance->optionChanged(i, readOption(i, {}));
+		}
+	}
+
+	QSet<QString> changedHosts(QSet<QString>::fromList(previousOverrideValues.keys()));
+	changedHosts.unite(QSet<QString>::fromList(m_overrideValues.keys()));
+
+	QSet<QString>::const_iterator iterator;
+
+	for (iterator = changedHosts.constBegin(); iterator != changedHosts.constEnd(); ++iterator)
+	{
+		const QHash<int, QVariant> previousHostValues(previousOverrideValues.value(*iterator));
+		const QHash<int, QVariant> hostValues(m_overrideValues.value(*iterator));
+		QSet<int> identifiers(QSet<int>::fromList(previousHostValues.keys()));
+		identifiers.unite(QSet<int>::fromList(hostValues.keys()));
+
+		QSet<int>::const_iterator identifiersIterator;
+
+		for (identifiersIterator = identifiers.constBegin(); identifiersIterator != identifiers.constEnd(); ++identifiersIterator)
+		{
+			if (previousHostValues.value(*identifiersIterator) != hostValues.value(*identifiersIterator))
+			{
+				emit m_instance->hostOptionChanged(*identifiersIterator, hostValues.value(*identifiersIterator), *iterator);
+			}
 		}
 	}
 }
 
 void SettingsManager::removeOverride(const QString &host, int identifier)
 {
-	if (identifier < 0)
+	OptionChange change;
+	change.host = host;
+	change.identifier = identifier;
+
+	QVector<int> identifiers;
+
 	{
-		QSettings(m_overridePath, QSettings::IniFormat).remove(host);
+		QWriteLocker locker(&m_valuesLock);
+		const QHash<int, QVariant> hostValues(m_overrideValues.value(host));
+
+		if (identifier < 0)
+		{
+			identifiers = hostValues.keys().toVector();
+		}
+		else if (hostValues.contains(identifier))
+		{
+			identifiers.append(identifier);
+		}
+
+		applyOptionChange(change);
 	}
-	else
+
+	m_instance->scheduleSave(change);
+
+	for (int i = 0; i < identifiers.count(); ++i)
 	{
-		QSettings(m_overridePath, QSettings::IniFormat).remove(host + QLatin1Char('/') + getOptionName(identifier));
+		emit m_instance->hostOptionChanged(identifiers.at(i), {}, host);
 	}
 }
 
@@ -283,69 +479,295 @@ void SettingsManager::registerOption(int identifier, OptionType type, const QVar
 	m_definitions.append(definition);
 }
 
-void SettingsManager::saveOption(const QString &path, const QString &key, const QVariant &value, OptionType type)
+void SettingsManager::applyOptionChange(const OptionChange &change)
 {
-	if (value.isNull())
+	if (change.host.isEmpty())
 	{
-		QSettings(path, QSettings::IniFormat).remove(key);
+		if (change.identifier >= m_globalValues.count())
+		{
+			m_globalValues.resize(m_definitions.count());
+		}
+
+		m_globalValues[change.identifier] = (change.value.isNull() ? QVariant() : createStoredValue(change.value, change.type));
+
+		return;
 	}
-	else if (type == ColorType)
+
+	if (change.identifier < 0)
 	{
-		const QColor color(value.value<QColor>());
+		m_overrideValues.remove(change.host);
+	}
+	else if (change.value.isNull())
+	{
+		QHash<QString, QHash<int, QVariant> >::iterator iterator(m_overrideValues.find(change.host));
+
+		if (iterator != m_overrideValues.end())
+		{
+			iterator.value().remove(change.identifier);
 
-		QSettings(path, QSettings::IniFormat).setValue(key, (color.isValid() ? color.name(QColor::HexArgb).toUpper() : QString()));
+			if (iterator.value().isEmpty())
+			{
+				m_overrideValues.erase(iterator);
+			}
+		}
 	}
 	else
 	{
-		QSettings(path, QSettings::IniFormat).setValue(key, value);
+		m_overrideValues[change.host][change.identifier] = createStoredValue(change.value, change.type);
 	}
+
+	createOverridesIndex();
 }
 
-void SettingsManager::updateOptionDefinition(int identifier, const SettingsManager::OptionDefinition &definition)
+void SettingsManager::createOverridesIndex()
 {
-	if (identifier >= 0 && identifier < m_definitions.count())
+	m_overrideHosts = m_overrideValues.keys();
+	m_overrideHosts.sort();
+
+	m_overridesNodes.clear();
+	m_overridesNodes.append(OverridesNode());
+
+	for (int i = 0; i < m_overrideHosts.count(); ++i)
 	{
-		m_definitions[identifier].defaultValue = definition.defaultValue;
-		m_definitions[identifier].choices = definition.choices;
+		const QString &host(m_overrideHosts.at(i));
+		const bool isWildcarded(host.startsWith(QLatin1String("*.")));
+		const QStringList labels((isWildcarded ? host.mid(2) : host).split(QLatin1Char('.')));
+		int node(0);
+
+		for (int j = (labels.count() - 1); j >= 0; --j)
+		{
+			int child(m_overridesNodes.at(node).children.value(labels.at(j), -1));
+
+			if (child < 0)
+			{
+				child = m_overridesNodes.count();
+
+				m_overridesNodes[node].children.insert(labels.at(j), child);
+				m_overridesNodes.append(OverridesNode());
+			}
+
+			node = child;
+		}
+
+		if (isWildcarded)
+		{
+			m_overridesNodes[node].hasWildcardedOverride = true;
+		}
+		else
+		{
+			m_overridesNodes[node].hasOverride = true;
+		}
 	}
+
+	QMutexLocker locker(&m_resolvedOverridesMutex);
+
+	m_resolvedOverrides.clear();
 }
 
-void SettingsManager::setOption(int identifier, const QVariant &value, const QString &host)
+void SettingsManager::scheduleSave(const OptionChange &change)
 {
-	const QString name(getOptionName(identifier));
-	const OptionType type(getOptionDefinition(identifier).type);
+	m_pendingChanges.append(change);
 
-	if (!host.isEmpty())
+	if (m_saveTimer == 0)
+	{
+		m_saveTimer = startTimer(1000);
+	}
+}
+
+void SettingsManager::saveOptions(const QVector<OptionChange> &changes)
+{
+	QMutexLocker locker(&m_savingMutex);
+	QSettings globalSettings(m_globalPath, QSettings::IniFormat);
+	QSettings overrideSettings(m_overridePath, QSettings::IniFormat);
+
+	for (int i = 0; i < changes.count(); ++i)
 	{
-		const QString overrideName(host + QLatin1Char('/') + name);
+		const OptionChange &change(changes.at(i));
 
-		if (value.isNull())
+		if (change.host.isEmpty())
+		{
+			saveOption(globalSettings, getOptionName(change.identifier), change.value, change.type);
+		}
+		else if (change.identifier < 0)
 		{
-			QSettings(m_overridePath, QSettings::IniFormat).remove(overrideName);
+			overrideSettings.remove(change.host);
 		}
 		else
 		{
-			saveOption(m_overridePath, overrideName, value, type);
+			saveOption(overrideSettings, change.host + QLatin1Char('/') + getOptionName(change.identifier), change.value, change.type);
 		}
+	}
+
+	globalSettings.sync();
+	overrideSettings.sync();
+}
 
-		if (!m_hasWildcardedOverrides && overrideName.startsWith(QLatin1Char('*')))
+void SettingsManager::saveOption(QSettings &settings, const QString &key, const QVariant &value, OptionType type)
+{
+	if (value.isNull())
+	{
+		settings.remove(key);
+	}
+	else
+	{
+		settings.setValue(key, createStoredValue(value, type));
+	}
+}
+
+void SettingsManager::updateWatchedPaths()
+{
+	const QStringList watchedPaths(m_fileSystemWatcher->files());
+	const QStringList paths({m_globalPath, m_overridePath});
+
+	for (int i = 0; i < paths.count(); ++i)
+	{
+		if (!watchedPaths.contains(paths.at(i)) && QFile::exists(paths.at(i)))
 		{
-			m_hasWildcardedOverrides = true;
+			m_fileSystemWatcher->addPath(paths.at(i));
 		}
+	}
+}
+
+void SettingsManager::handleFileChanged()
+{
+	updateWatchedPaths();
+
+	if (m_saveTimer != 0 || m_savingAmount > 0)
+	{
+		m_needsReload = true;
+
+		return;
+	}
+
+	loadOptions();
+}
+
+void SettingsManager::handleOptionsSaved()
+{
+	--m_savingAmount;
+
+	updateWatchedPaths();
+
+	if (m_savingAmount > 0)
+	{
+		return;
+	}
+
+	m_savingFutures.clearFutures();
+
+	if (m_needsReload && m_saveTimer == 0)
+	{
+		m_needsReload = false;
+
+		loadOptions();
+	}
+}
+
+void SettingsManager::updateOptionDefinition(int identifier, const SettingsManager::OptionDefinition &definition)
+{
+	if (identifier >= 0 && identifier < m_definitions.count())
+	{
+		m_definitions[identifier].defaultValue = definition.defaultValue;
+		m_definitions[identifier].choices = definition.choices;
+	}
+}
+
+void SettingsManager::resetAccessStatistics()
+{
+	for (int i = 0; i < m_accessCountersAmount; ++i)
+	{
+		m_accessCounters[i].readsAmount.store(0, std::memory_order_relaxed);
+		m_accessCounters[i].readsTime.store(0, std::memory_order_relaxed);
+		m_accessCounters[i].writesAmount.store(0, std::memory_order_relaxed);
+		m_accessCounters[i].writesTime.store(0, std::memory_order_relaxed);
+	}
+}
+
+void SettingsManager::recordOptionAccess(int identifier, bool isHostSpecific, qint64 time, bool isWrite)
+{
+	if (identifier < 0 || identifier >= m_profiledOptionsLimit)
+	{
+		return;
+	}
+
+	OptionAccessCounters &counters(m_accessCounters[(((identifier * (NetworkSubsystem + 1)) + m_profilingSubsystem) * 2) + (isHostSpecific ? 1 : 0)]);
+
+	if (isWrite)
+	{
+		counters.writesAmount.fetch_add(1, std::memory_order_relaxed);
+		counters.writesTime.fetch_add(static_cast<quint64>(time), std::memory_order_relaxed);
+	}
+	else
+	{
+		counters.readsAmount.fetch_add(1, std::memory_order_relaxed);
+		counters.readsTime.fetch_add(static_cast<quint64>(time), std::memory_order_relaxed);
+	}
+}
+
+void SettingsManager::setOption(int identifier, const QVariant &value, const QString &host)
+{
+	if (!m_isProfilingEnabled.load(std::memory_order_relaxed))
+	{
+		writeOption(identifier, value, host);
+
+		return;
+	}
+
+	QElapsedTimer timer;
+	timer.start();
+
+	writeOption(identifier, value, host);
+
+	recordOptionAccess(identifier, !host.isEmpty(), timer.nsecsElapsed(), true);
+}
+
+void SettingsManager::writeOption(int identifier, const QVariant &value, const QString &host)
+{
+	if (identifier < 0 || identifier >= m_definitions.count())
+	{
+		return;
+	}
+
+	OptionChange change;
+	change.host = host;
+	change.value = value;
+	change.type = m_definitions.at(identifier).type;
+	change.identifier = identifier;
+
+	if (!host.isEmpty())
+	{
+		{
+			QWriteLocker locker(&m_valuesLock);
+
+			applyOptionChange(change);
+		}
+
+		m_instance->scheduleSave(change);
 
 		emit m_instance->hostOptionChanged(identifier, value, host);
 
 		return;
 	}
 
-	if (getOption(identifier) != value)
+	if (readOption(identifier, {}) != value)
 	{
-		saveOption(m_globalPath, name, value, type);
+		{
+			QWriteLocker locker(&m_valuesLock);
+
+			applyOptionChange(change);
+		}
+
+		m_instance->scheduleSave(change);
 
 		emit m_instance->optionChanged(identifier, value);
 	}
 }
 
+void SettingsManager::setProfilingEnabled(bool isEnabled)
+{
+	m_isProfilingEnabled.store(isEnabled, std::memory_order_relaxed);
+}
+
 SettingsManager* SettingsManager::getInstance()
 {
 	return m_instance;
@@ -397,6 +819,18 @@ QString SettingsManager::createDisplayValue(int identifier, const QVariant &valu
 	return value.toString();
 }
 
+QVariant SettingsManager::createStoredValue(const QVariant &value, OptionType type)
+{
+	if (type == ColorType)
+	{
+		const QColor color(value.value<QColor>());
+
+		return (color.isValid() ? color.name(QColor::HexArgb).toUpper() : QString());
+	}
+
+	return value;
+}
+
 QString SettingsManager::createReport()
 {
 	QString report;
@@ -405,28 +839,29 @@ QString SettingsManager::createReport()
 	stream << QLatin1String("Settings:\n");
 
 	QHash<QString, int> overridenValues;
-	QSettings overrides(m_overridePath, QSettings::IniFormat);
-	const QStringList overridesGroups(overrides.childGroups());
 
-	for (int i = 0; i < overridesGroups.count(); ++i)
 	{
-		overrides.beginGroup(overridesGroups.at(i));
-
-		const QStringList keys(overrides.allKeys());
+		QReadLocker locker(&m_valuesLock);
+		QHash<QString, QHash<int, QVariant> >::const_iterator hostsIterator;
 
-		for (int j = 0; j < keys.count(); ++j)
+		for (hostsIterator = m_overrideValues.constBegin(); hostsIterator != m_overrideValues.constEnd(); ++hostsIterator)
 		{
-			if (overridenValues.contains(keys.at(j)))
-			{
-				++overridenValues[keys.at(j)];
-			}
-			else
+			QHash<int, QVariant>::const_iterator valuesIterator;
+
+			for (valuesIterator = hostsIterator.value().constBegin(); valuesIterator != hostsIterator.value().constEnd(); ++valuesIterator)
 			{
-				overridenValues[keys.at(j)] = 1;
+				const QString name(getOptionName(valuesIterator.key()));
+
+				if (overridenValues.contains(name))
+				{
+					++overridenValues[name];
+				}
+				else
+				{
+					overridenValues[name] = 1;
+				}
 			}
 		}
-
-		overrides.endGroup();
 	}
 
 	const QStringList options(getOptions());
@@ -449,7 +884,7 @@ QString SettingsManager::createReport()
 			stream << definition.defaultValue.toString();
 		}
 
-		stream << ((definition.defaultValue == getOption(definition.identifier)) ? QLatin1String("default") : QLatin1String("non default"));
+		stream << ((definition.defaultValue == readOption(definition.identifier, {})) ? QLatin1String("default") : QLatin1String("non default"));
 		stream << (overridenValues.contains(options.at(i)) ? QStringLiteral("%1 override(s)").arg(overridenValues[options.at(i)]) : QLatin1String("no overrides"));
 		stream.setFieldWidth(0);
 		stream << QLatin1Char('\n');
@@ -457,9 +892,58 @@ QString SettingsManager::createReport()
 
 	stream << QLatin1Char('\n');
 
+	if (!isProfilingEnabled())
+	{
+		return report;
+	}
+
+	QVector<OptionAccessStatistics> statistics(getAccessStatistics());
+
+	std::sort(statistics.begin(), statistics.end(), [&](const OptionAccessStatistics &first, const OptionAccessStatistics &second)
+	{
+		return ((first.readsAmount + first.writesAmount) > (second.readsAmount + second.writesAmount));
+	});
+
+	stream << QLatin1String("Settings Access:\n");
+
+	for (int i = 0; i < qMin(statistics.count(), 50); ++i)
+	{
+		const OptionAccessStatistics &entry(statistics.at(i));
+
+		stream << QLatin1Char('\t');
+		stream.setFieldWidth(50);
+		stream << getOptionName(entry.identifier);
+		stream.setFieldWidth(30);
+		stream << (entry.isHostSpecific ? QLatin1String("host") : QLatin1String("global"));
+		stream.setFieldWidth(10);
+		stream << getProfilingSubsystemName(entry.subsystem);
+		stream.setFieldWidth(30);
+		stream << QStringLiteral("%1 read(s), %2 us").arg(entry.readsAmount).arg(entry.readsTime / 1000);
+		stream << QStringLiteral("%1 write(s), %2 us").arg(entry.writesAmount).arg(entry.writesTime / 1000);
+		stream.setFieldWidth(0);
+		stream << QLatin1Char('\n');
+	}
+
+	stream << QLatin1Char('\n');
+
 	return report;
 }
 
+QString SettingsManager::getProfilingSubsystemName(ProfilingSubsystem subsystem)
+{
+	switch (subsystem)
+	{
+		case WebSubsystem:
+			return QLatin1String("web");
+		case NetworkSubsystem:
+			return QLatin1String("network");
+		default:
+			break;
+	}
+
+	return QLatin1String("other");
+}
+
 QString SettingsManager::getGlobalPath()
 {
 	return m_globalPath;
@@ -486,37 +970,44 @@ QString SettingsManager::getOptionName(int identifier)
 
 QVariant SettingsManager::getOption(int identifier, const QString &host)
 {
-	if (identifier < 0 || identifier >= m_definitions.count())
+	if (!m_isProfilingEnabled.load(std::memory_order_relaxed))
 	{
-		return {};
+		return readOption(identifier, host);
 	}
 
-	const QString name(getOptionName(identifier));
+	QElapsedTimer timer;
+	timer.start();
+
+	const QVariant value(readOption(identifier, host));
+
+	recordOptionAccess(identifier, !host.isEmpty(), timer.nsecsElapsed(), false);
 
-	if (host.isEmpty())
+	return value;
+}
+
+QVariant SettingsManager::readOption(int identifier, const QString &host)
+{
+	if (identifier < 0 || identifier >= m_definitions.count())
 	{
-		return QSettings(m_globalPath, QSettings::IniFormat).value(name, m_definitions.at(identifier).defaultValue);
+		return {};
 	}
 
-	const QString overrideName(host + QLatin1Char('/') + name);
-	const QSettings overrides(m_overridePath, QSettings::IniFormat);
+	QReadLocker locker(&m_valuesLock);
 
-	if (m_hasWildcardedOverrides && !overrides.contains(overrideName))
+	if (!host.isEmpty() && !m_overrideHosts.isEmpty())
 	{
-		const QStringList hostParts(host.split(QLatin1Char('.')));
+		const QHash<int, QVariant> overrides(getHostOverrides(host));
+		const QHash<int, QVariant>::const_iterator iterator(overrides.constFind(identifier));
 
-		for (int i = 1; i < hostParts.count(); ++i)
+		if (iterator != overrides.constEnd())
 		{
-			const QString wildcardedName(QLatin1String("*.") + QStringList(hostParts.mid(i)).join(QLatin1Char('.')) + QLatin1Char('/') + name);
-
-			if (overrides.contains(wildcardedName))
-			{
-				return QSettings(m_overridePath, QSettings::IniFormat).value(wildcardedName, getOption(identifier));
-			}
+			return iterator.value();
 		}
 	}
 
-	return QSettings(m_overridePath, QSettings::IniFormat).value(overrideName, getOption(identifier));
+	const QVariant value(m_globalValues.value(identifier));
+
+	return (value.isValid() ? value : m_definitions.at(identifier).defaultValue);
 }
 
 QStringList SettingsManager::getOptions()
@@ -536,27 +1027,79 @@ QStringList SettingsManager::getOptions()
 
 QStringList SettingsManager::getOverrideHosts(int identifier)
 {
+	QReadLocker locker(&m_valuesLock);
+
 	if (identifier < 0)
 	{
-		return QSettings(m_overridePath, QSettings::IniFormat).childGroups();
+		return m_overrideHosts;
 	}
 
-	const QSettings overrides(m_overridePath, QSettings::IniFormat);
-	const QStringList overridesGroups(overrides.childGroups());
 	QStringList hosts;
-	const QString optionName(getOptionName(identifier));
 
-	for (int i = 0; i < overridesGroups.count(); ++i)
+	for (int i = 0; i < m_overrideHosts.count(); ++i)
 	{
-		if (overrides.contains(overridesGroups.at(i) + QLatin1Char('/') + optionName))
+		if (m_overrideValues.value(m_overrideHosts.at(i)).contains(identifier))
 		{
-			hosts.append(overridesGroups.at(i));
+			hosts.append(m_overrideHosts.at(i));
 		}
 	}
 
 	return hosts;
 }
 
+QHash<int, QVariant> SettingsManager::getHostOverrides(const QString &host)
+{
+	QMutexLocker locker(&m_resolvedOverridesMutex);
+	const QHash<QString, QHash<int, QVariant> >::const_iterator resolvedIterator(m_resolvedOverrides.constFind(host));
+
+	if (resolvedIterator != m_resolvedOverrides.constEnd())
+	{
+		return resolvedIterator.value();
+	}
+
+	locker.unlock();
+
+	const QStringList labels(host.split(QLatin1Char('.')));
+	QHash<int, QVariant> overrides;
+	int node(0);
+
+	for (int i = (labels.count() - 1); i >= 0; --i)
+	{
+		node = m_overridesNodes.at(node).children.value(labels.at(i), -1);
+
+		if (node < 0)
+		{
+			break;
+		}
+
+		const OverridesNode &overridesNode(m_overridesNodes.at(node));
+
+		if (i == 0 ? !overridesNode.hasOverride : !overridesNode.hasWildcardedOverride)
+		{
+			continue;
+		}
+
+		const QHash<int, QVariant> hostOverrides(m_overrideValues.value((i == 0) ? host : QLatin1String("*.") + QStringList(labels.mid(i)).join(QLatin1Char('.'))));
+		QHash<int, QVariant>::const_iterator iterator;
+
+		for (iterator = hostOverrides.constBegin(); iterator != hostOverrides.constEnd(); ++iterator)
+		{
+			overrides[iterator.key()] = iterator.value();
+		}
+	}
+
+	locker.relock();
+
+	if (m_resolvedOverrides.count() >= m_resolvedOverridesLimit)
+	{
+		m_resolvedOverrides.clear();
+	}
+
+	m_resolvedOverrides[host] = overrides;
+
+	return overrides;
+}
+
 SettingsManager::OptionDefinition SettingsManager::getOptionDefinition(int identifier)
 {
 	if (identifier >= 0 && identifier < m_definitions.count())
@@ -567,6 +1110,34 @@ SettingsManager::OptionDefinition SettingsManager::getOptionDefinition(int ident
 	return {};
 }
 
+QVector<SettingsManager::OptionAccessStatistics> SettingsManager::getAccessStatistics()
+{
+	QVector<OptionAccessStatistics> statistics;
+
+	for (int i = 0; i < m_accessCountersAmount; ++i)
+	{
+		const OptionAccessCounters &counters(m_accessCounters[i]);
+		OptionAccessStatistics entry;
+		entry.readsAmount = counters.readsAmount.load(std::memory_order_relaxed);
+		entry.writesAmount = counters.writesAmount.load(std::memory_order_relaxed);
+
+		if (entry.readsAmount == 0 && entry.writesAmount == 0)
+		{
+			continue;
+		}
+
+		entry.subsystem = static_cast<ProfilingSubsystem>((i / 2) % (NetworkSubsystem + 1));
+		entry.readsTime = counters.readsTime.load(std::memory_order_relaxed);
+		entry.writesTime = counters.writesTime.load(std::memory_order_relaxed);
+		entry.identifier = (i / (2 * (NetworkSubsystem + 1)));
+		entry.isHostSpecific = ((i % 2) == 1);
+
+		statistics.append(entry);
+	}
+
+	return statistics;
+}
+
 int SettingsManager::registerOption(const QString &name, OptionType type, const QVariant &defaultValue, const QStringList &choices, OptionDefinition::OptionFlags flags)
 {
 	if (name.isEmpty() || getOptionIdentifier(name) >= 0)
@@ -589,6 +1160,29 @@ int SettingsManager::registerOption(const QString &name, OptionType type, const
 
 	m_definitions.append(definition);
 
+	if (!m_globalPath.isEmpty())
+	{
+		const QSettings globalSettings(m_globalPath, QSettings::IniFormat);
+		const QSettings overrideSettings(m_overridePath, QSettings::IniFormat);
+		const QStringList hosts(overrideSettings.childGroups());
+		QWriteLocker locker(&m_valuesLock);
+
+		m_globalValues.resize(m_definitions.count());
+		m_globalValues[identifier] = globalSettings.value(name);
+
+		for (int i = 0; i < hosts.count(); ++i)
+		{
+			const QString key(hosts.at(i) + QLatin1Char('/') + name);
+
+			if (overrideSettings.contains(key))
+			{
+				m_overrideValues[hosts.at(i)][identifier] = overrideSettings.value(key);
+			}
+		}
+
+		createOverridesIndex();
+	}
+
 	return identifier;
 }
 
@@ -612,12 +1206,19 @@ int SettingsManager::getOptionIdentifier(const QString &name)
 
 bool SettingsManager::hasOverride(const QString &host, int identifier)
 {
+	QReadLocker locker(&m_valuesLock);
+
 	if (identifier < 0)
 	{
-		return QSettings(m_overridePath, QSettings::IniFormat).childGroups().contains(host);
+		return m_overrideValues.contains(host);
 	}
 
-	return QSettings(m_overridePath, QSettings::IniFormat).contains(host + QLatin1Char('/') + getOptionName(identifier));
+	return m_overrideValues.value(host).contains(identifier);
+}
+
+bool SettingsManager::isProfilingEnabled()
+{
+	return m_isProfilingEnabled.load(std::memory_order_relaxed);
 }
 
 }
@@ -22,10 +22,17 @@
 #ifndef OTTER_SETTINGSMANAGER_H
 #define OTTER_SETTINGSMANAGER_H
 
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QFutureSynchronizer>
+#include <QtCore/QMutex>
 #include <QtCore/QObject>
+#include <QtCore/QReadWriteLock>
+#include <QtCore/QSettings>
 #include <QtCore/QVariant>
 #include <QtGui/QIcon>
 
+#include <atomic>
+
 namespace Otter
 {
 
@@ -104,6 +111,7 @@ public:
 		Content_ZoomTextOnlyOption,
 		ContentBlocking_EnableContentBlockingOption,
 		ContentBlocking_IgnoreHostsOption,
+		ContentBlocking_PendingRequestsPolicyOption,
 		ContentBlocking_ProfilesOption,
 		History_BrowsingLimitAmountGlobalOption,
 		History_BrowsingLimitAmountWindowOption,
@@ -302,13 +310,47 @@ public:
 		}
 	};
 
+	enum ProfilingSubsystem
+	{
+		UnknownSubsystem = 0,
+		WebSubsystem,
+		NetworkSubsystem
+	};
+
+	class ProfilingScope final
+	{
+	public:
+		explicit ProfilingScope(ProfilingSubsystem subsystem);
+		~ProfilingScope();
+
+	private:
+		ProfilingSubsystem m_previousSubsystem;
+	};
+
+	struct OptionAccessStatistics final
+	{
+		ProfilingSubsystem subsystem = UnknownSubsystem;
+		quint64 readsAmount = 0;
+		quint64 readsTime = 0;
+		quint64 writesAmount = 0;
+		quint64 writesTime = 0;
+		int identifier = -1;
+		bool isHostSpecific = false;
+	};
+
+	~SettingsManager();
+
 	static void createInstance(const QString &path);
+	static void loadOptions();
 	static void removeOverride(const QString &host, int identifier = -1);
 	static void updateOptionDefinition(int identifier, const OptionDefinition &definition);
+	static void resetAccessStatistics();
 	static void setOption(int identifier, const QVariant &value, const QString &host = {});
+	static void setProfilingEnabled(bool isEnabled);
 	static SettingsManager* getInstance();
 	static QString createDisplayValue(int identifier, const QVariant &value);
 	static QString createReport();
+	static QString getProfilingSubsystemName(ProfilingSubsystem subsystem);
 	static QString getGlobalPath();
 	static QString getOverridePath();
 	static QString getOptionName(int identifier);
@@ -316,25 +358,89 @@ public:
 	static QStringList getOptions();
 	static QStringList getOverrideHosts(int identifier = -1);
 	static OptionDefinition getOptionDefinition(int identifier);
+	static QVector<OptionAccessStatistics> getAccessStatistics();
 	static int registerOption(const QString &name, OptionType type, const QVariant &defaultValue = {}, const QStringList &choices = {}, OptionDefinition::OptionFlags flags = static_cast<OptionDefinition::OptionFlags>(OptionDefinition::IsEnabledFlag | OptionDefinition::IsVisibleFlag));
 	static int getOptionIdentifier(const QString &name);
 	static bool hasOverride(const QString &host, int identifier = -1);
+	static bool isProfilingEnabled();
 
 protected:
+	struct OptionChange final
+	{
+		QString host;
+		QVariant value;
+		OptionType type = UnknownType;
+		int identifier = -1;
+	};
+
+	struct OverridesNode final
+	{
+		QHash<QString, int> children;
+		bool hasOverride = false;
+		bool hasWildcardedOverride = false;
+	};
+
+	struct OptionAccessCounters final
+	{
+		std::atomic<quint64> readsAmount;
+		std::atomic<quint64> readsTime;
+		std::atomic<quint64> writesAmount;
+		std::atomic<quint64> writesTime;
+
+		OptionAccessCounters() : readsAmount(0), readsTime(0), writesAmount(0), writesTime(0)
+		{
+		}
+	};
+
 	explicit SettingsManager(QObject *parent);
 
+	void timerEvent(QTimerEvent *event) override;
+	void scheduleSave(const OptionChange &change);
+	void updateWatchedPaths();
 	static void registerOption(int identifier, OptionType type, const QVariant &defaultValue = {}, const QStringList &choices = {}, OptionDefinition::OptionFlags flags = static_cast<OptionDefinition::OptionFlags>(OptionDefinition::IsEnabledFlag | OptionDefinition::IsVisibleFlag | OptionDefinition::IsBuiltInFlag));
-	static void saveOption(const QString &path, const QString &key, const QVariant &value, OptionType type);
+	static void applyOptionChange(const OptionChange &change);
+	static void writeOption(int identifier, const QVariant &value, const QString &host);
+	static void recordOptionAccess(int identifier, bool isHostSpecific, qint64 time, bool isWrite);
+	static void createOverridesIndex();
+	static void saveOptions(const QVector<OptionChange> &changes);
+	static void saveOption(QSettings &settings, const QString &key, const QVariant &value, OptionType type);
+	static QVariant createStoredValue(const QVariant &value, OptionType type);
+	static QVariant readOption(int identifier, const QString &host);
+	static QHash<int, QVariant> getHostOverrides(const QString &host);
+
+protected slots:
+	void handleFileChanged();
+	void handleOptionsSaved();
 
 private:
+	QFileSystemWatcher *m_fileSystemWatcher;
+	QFutureSynchronizer<void> m_savingFutures;
+	QVector<OptionChange> m_pendingChanges;
+	int m_saveTimer;
+	int m_savingAmount;
+	bool m_needsReload;
+
 	static SettingsManager *m_instance;
 	static QString m_globalPath;
 	static QString m_overridePath;
 	static QVector<OptionDefinition> m_definitions;
+	static QVector<QVariant> m_globalValues;
+	static QHash<QString, QHash<int, QVariant> > m_overrideValues;
+	static QHash<QString, QHash<int, QVariant> > m_resolvedOverrides;
+	static QVector<OverridesNode> m_overridesNodes;
+	static QStringList m_overrideHosts;
 	static QHash<QString, int> m_customOptions;
+	static QReadWriteLock m_valuesLock;
+	static QMutex m_savingMutex;
+	static QMutex m_resolvedOverridesMutex;
 	static int m_identifierCounter;
 	static int m_optionIdentifierEnumerator;
-	static bool m_hasWildcardedOverrides;
+	static std::atomic<bool> m_isProfilingEnabled;
+	static thread_local ProfilingSubsystem m_profilingSubsystem;
+	static const int m_resolvedOverridesLimit = 1000;
+	static const int m_profiledOptionsLimit = 512;
+	static const int m_accessCountersAmount = (m_profiledOptionsLimit * (NetworkSubsystem + 1) * 2);
+	static OptionAccessCounters m_accessCounters[m_accessCountersAmount];
 
 signals:
 	void optionChanged(int identifier, const QVariant &value);
@@ -32,7 +32,11 @@
 #include "../../../../ui/LineEditWidget.h"
 
 #include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
 #include <QtCore/QRegularExpression>
+#include <QtCore/QUuid>
 #include <QtWebEngineWidgets/QWebEngineHistory>
 #include <QtWebEngineWidgets/QWebEngineProfile>
 #include <QtWebEngineWidgets/QWebEngineScript>
@@ -50,6 +54,8 @@ QtWebEnginePage::QtWebEnginePage(bool isPrivate, QtWebEngineWebWidget *parent) :
 	m_isViewingMedia(false),
 	m_isPopup(false)
 {
+	m_cosmeticFiltersToken = QUuid::createUuid().toString();
+
 	if (isPrivate && m_widget)
 	{
 		connect(profile(), &QWebEngineProfile::downloadRequested, qobject_cast<QtWebEngineWebBackend*>(m_widget->getBackend()), &QtWebEngineWebBackend::handleDownloadRequested);
@@ -77,7 +83,7 @@ void QtWebEnginePage::validatePopup(const QUrl &url)
 
 		if (result.isBlocked)
 		{
-			Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg(ContentFiltersManager::getProfile(result.profile)->getTitle(), result.rule), Console::NetworkCategory, Console::LogLevel, url.url(), -1, (m_widget ? m_widget->getWindowIdentifier() : 0));
+			Console::addBlockedRequest(url, result.rule, ContentFiltersManager::getProfile(result.profile)->getName(), (m_widget ? m_widget->getWindowIdentifier() : 0));
 
 			return;
 		}
@@ -132,6 +138,18 @@ void QtWebEnginePage::javaScriptAlert(const QUrl &url, const QString &message)
 
 void QtWebEnginePage::javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString &note, int line, const QString &source)
 {
+	if (note.startsWith(m_cosmeticFiltersToken))
+	{
+		if (m_widget)
+		{
+			const QJsonObject tokensObject(QJsonDocument::fromJson(note.mid(m_cosmeticFiltersToken.length()).toUtf8()).object());
+
+			addStyleSheet(ContentFiltersManager::getCosmeticFiltersStyleSheet(ContentFiltersManager::getProfileIdentifiers(m_widget->getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList()), m_widget->getUrl(), tokensObject.value(QLatin1String("identifiers")).toVariant().toStringList(), tokensObject.value(QLatin1String("classes")).toVariant().toStringList()));
+		}
+
+		return;
+	}
+
 	Console::MessageLevel mappedLevel(Console::LogLevel);
 
 	if (level == WarningMessageLevel)
@@ -146,6 +164,14 @@ void QtWebEnginePage::javaScriptConsoleMessage(JavaScriptConsoleMessageLevel lev
 	Console::addMessage(note, Console::JavaScriptCategory, mappedLevel, source, line, (m_widget ? m_widget->getWindowIdentifier() : 0));
 }
 
+void QtWebEnginePage::addStyleSheet(const QString &styleSheet)
+{
+	if (!styleSheet.isEmpty())
+	{
+		runJavaScript(QLatin1String("(function(styleSheet) { var element = document.createElement('style'); element.textContent = styleSheet; (document.head || document.documentElement).appendChild(element); })(") + QString::fromUtf8(QJsonDocument(QJsonArray({styleSheet})).toJson(QJsonDocument::Compact)) + QLatin1String("[0]);"), QWebEngineScript::ApplicationWorld);
+	}
+}
+
 void QtWebEnginePage::handleLoadFinished()
 {
 	m_isIgnoringJavaScriptPopups = false;
@@ -159,7 +185,7 @@ void QtWebEnginePage::handleLoadFinished()
 
 		if (entry.identifier > 0 && !profile()->isOffTheRecord())
 		{
-			HistoryManager::updateEntry(entry.identifier, url(), (m_widget ? m_widget->getTitle() : title()), icon());
+			HistoryManager::updateEntry(entry.identifier, url(), (m_widget ? m_widget->getTitle() : title()), icon(), iconUrl());
 		}
 
 		m_history[historyIndex] = entry;
@@ -169,25 +195,10 @@ void QtWebEnginePage::handleLoadFinished()
 	{
 		if (m_widget)
 		{
-			const QUrl url(m_widget->getUrl());
-			const ContentFiltersManager::CosmeticFiltersResult cosmeticFilters(ContentFiltersManager::getCosmeticFilters(ContentFiltersManager::getProfileIdentifiers(m_widget->getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList()), url));
-
-			if (!cosmeticFilters.rules.isEmpty() || !cosmeticFilters.exceptions.isEmpty())
-			{
-				QFile file(QLatin1String(":/modules/backends/web/qtwebengine/resources/hideElements.js"));
-
-				if (file.open(QIODevice::ReadOnly))
-				{
-					runJavaScript(QString::fromLatin1(file.readAll()).arg(createJavaScriptList(cosmeticFilters.exceptions), createJavaScriptList(cosmeticFilters.rules)));
-
-					file.close();
-				}
-			}
-
 #if QTWEBENGINECORE_VERSION >= 0x050D00
-			const QStringList blockedRequests(m_widget->getBlockedElements());
+			const QSet<QString> blockedRequests(m_widget->getBlockedElements());
 #else
-			const QStringList blockedRequests(qobject_cast<QtWebEngineWebBackend*>(m_widget->getBackend())->getBlockedElements(url.host()));
+			const QSet<QString> blockedRequests(qobject_cast<QtWebEngineWebBackend*>(m_widget->getBackend())->getBlockedElements(m_widget->getUrl().host()));
 #endif
 
 			if (!blockedRequests.isEmpty())
@@ -196,7 +207,15 @@ void QtWebEnginePage::handleLoadFinished()
 
 				if (file.open(QIODevice::ReadOnly))
 				{
-					runJavaScript(QString::fromLatin1(file.readAll()).arg(createJavaScriptList(blockedRequests)));
+					QJsonObject requestsObject;
+					QSet<QString>::const_iterator iterator;
+
+					for (iterator = blockedRequests.constBegin(); iterator != blockedRequests.constEnd(); ++iterator)
+					{
+						requestsObject.insert(*iterator, true);
+					}
+
+					runJavaScript(QString::fromLatin1(file.readAll()).arg(QString::fromUtf8(QJsonDocument(requestsObject).toJson(QJsonDocument::Compact))));
 
 					file.close();
 				}
@@ -337,23 +356,6 @@ QtWebEngineWebWidget* QtWebEnginePage::createWidget(SessionsManager::OpenHints h
 	return widget;
 }
 
-QString QtWebEnginePage::createJavaScriptList(const QStringList &rules) const
-{
-	if (rules.isEmpty())
-	{
-		return {};
-	}
-
-	QStringList parsedRules(rules);
-
-	for (int i = 0; i < rules.count(); ++i)
-	{
-		parsedRules[i].replace(QLatin1Char('\''), QLatin1String("\\'"));
-	}
-
-	return QLatin1Char('\'') + parsedRules.join(QLatin1String("','")) + QLatin1Char('\'');
-}
-
 QString QtWebEnginePage::createScriptSource(const QString &path, const QStringList &parameters) const
 {
 	QFile file(QLatin1String(":/modules/backends/web/qtwebengine/resources/") + path + QLatin1String(".js"));
@@ -592,6 +594,29 @@ bool QtWebEnginePage::acceptNavigationRequest(const QUrl &url, NavigationType ty
 		scripts().insert(script);
 	}
 
+	if (m_widget)
+	{
+		const QVector<int> profiles(ContentFiltersManager::getProfileIdentifiers(m_widget->getOption(SettingsManager::ContentBlocking_ProfilesOption, url).toStringList()));
+
+		if (!profiles.isEmpty())
+		{
+			QWebEngineScript styleSheetScript;
+			styleSheetScript.setSourceCode(qobject_cast<QtWebEngineWebBackend*>(m_widget->getBackend())->getCosmeticFiltersScript(profiles, url));
+			styleSheetScript.setInjectionPoint(QWebEngineScript::DocumentCreation);
+			styleSheetScript.setWorldId(QWebEngineScript::ApplicationWorld);
+			styleSheetScript.setRunsOnSubFrames(false);
+
+			QWebEngineScript tokensScript;
+			tokensScript.setSourceCode(createScriptSource(QLatin1String("cosmeticFilters"), {m_cosmeticFiltersToken}));
+			tokensScript.setInjectionPoint(QWebEngineScript::DocumentCreation);
+			tokensScript.setWorldId(QWebEngineScript::ApplicationWorld);
+			tokensScript.setRunsOnSubFrames(false);
+
+			scripts().insert(styleSheetScript);
+			scripts().insert(tokensScript);
+		}
+	}
+
 	emit aboutToNavigate(url, type);
 
 	return true;
@@ -67,11 +67,11 @@ public:
 
 protected:
 	void markAsPopup();
+	void addStyleSheet(const QString &styleSheet);
 	void javaScriptAlert(const QUrl &url, const QString &message) override;
 	void javaScriptConsoleMessage(JavaScriptConsoleMessageLevel level, const QString &note, int line, const QString &source) override;
 	QWebEnginePage* createWindow(WebWindowType type) override;
 	QtWebEngineWebWidget* createWidget(SessionsManager::OpenHints hints);
-	QString createJavaScriptList(const QStringList &rules) const;
 	QStringList chooseFiles(FileSelectionMode mode, const QStringList &oldFiles, const QStringList &acceptedMimeTypes) override;
 	bool acceptNavigationRequest(const QUrl &url, NavigationType type, bool isMainFrame) override;
 #if QTWEBENGINECORE_VERSION >= 0x050E00
@@ -91,6 +91,7 @@ private:
 #endif
 	QVector<QtWebEnginePage*> m_popups;
 	QVector<HistoryEntryInformation> m_history;
+	QString m_cosmeticFiltersToken;
 	NavigationType m_previousNavigationType;
 	bool m_isIgnoringJavaScriptPopups;
 	bool m_isViewingMedia;
@@ -24,8 +24,6 @@
 #include "../../../../core/SettingsManager.h"
 #include "../../../../core/Utils.h"
 
-#include <QtCore/QCoreApplication>
-
 namespace Otter
 {
 
@@ -40,6 +38,8 @@ QtWebEngineUrlRequestInterceptor::QtWebEngineUrlRequestInterceptor(QtWebEngineWe
 
 void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &request)
 {
+	const SettingsManager::ProfilingScope profilingScope(SettingsManager::NetworkSubsystem);
+
 	if (!m_areImagesEnabled && request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage)
 	{
 		request.block(true);
@@ -100,11 +100,11 @@ void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo
 		{
 			const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(result.profile));
 
-			Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg(profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)"), result.rule), Console::NetworkCategory, Console::LogLevel, request.requestUrl().toString(), -1);
+			Console::addBlockedRequest(request.requestUrl(), result.rule, (profile ? profile->getName() : QString()));
 
-			if (storeBlockedUrl && !m_blockedElements.contains(request.requestUrl().url()))
+			if (storeBlockedUrl)
 			{
-				m_blockedElements.append(request.requestUrl().url());
+				m_blockedElements.insert(request.requestUrl().adjusted(QUrl::RemoveFragment).toString(QUrl::FullyEncoded));
 			}
 
 			NetworkManager::ResourceInformation resource;
@@ -199,7 +199,7 @@ QVariant QtWebEngineUrlRequestInterceptor::getPageInformation(WebWidget::PageInf
 	return {};
 }
 
-QStringList QtWebEngineUrlRequestInterceptor::getBlockedElements() const
+QSet<QString> QtWebEngineUrlRequestInterceptor::getBlockedElements() const
 {
 	return m_blockedElements;
 }
@@ -250,13 +250,15 @@ void QtWebEngineUrlRequestInterceptor::handleOptionChanged(int identifier)
 	}
 }
 
-QStringList QtWebEngineUrlRequestInterceptor::getBlockedElements(const QString &domain) const
+QSet<QString> QtWebEngineUrlRequestInterceptor::getBlockedElements(const QString &domain) const
 {
 	return m_blockedElements.value(domain);
 }
 
 void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo &request)
 {
+	const SettingsManager::ProfilingScope profilingScope(SettingsManager::NetworkSubsystem);
+
 	if (!m_areImagesEnabled && request.resourceType() == QWebEngineUrlRequestInfo::ResourceTypeImage)
 	{
 		request.block(true);
@@ -333,11 +335,11 @@ void QtWebEngineUrlRequestInterceptor::interceptRequest(QWebEngineUrlRequestInfo
 		{
 			const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(result.profile));
 
-			Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg((profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), result.rule), Console::NetworkCategory, Console::LogLevel, request.requestUrl().toString(), -1);
+			Console::addBlockedRequest(request.requestUrl(), result.rule, (profile ? profile->getName() : QString()));
 
-			if (storeBlockedUrl && !m_blockedElements.value(request.firstPartyUrl().host()).contains(request.requestUrl().url()))
+			if (storeBlockedUrl)
 			{
-				m_blockedElements[request.firstPartyUrl().host()].append(request.requestUrl().url());
+				m_blockedElements[request.firstPartyUrl().host()].insert(request.requestUrl().adjusted(QUrl::RemoveFragment).toString(QUrl::FullyEncoded));
 			}
 
 			request.block(true);
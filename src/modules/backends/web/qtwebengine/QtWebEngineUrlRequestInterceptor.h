@@ -25,6 +25,7 @@
 #include "../../../../core/NetworkManager.h"
 #include "../../../../core/NetworkManagerFactory.h"
 
+#include <QtCore/QSet>
 #if QTWEBENGINECORE_VERSION < 0x050D00
 #include <QtCore/QMap>
 #include <QtCore/QVector>
@@ -44,7 +45,7 @@ public:
 	explicit QtWebEngineUrlRequestInterceptor(QtWebEngineWebWidget *parent);
 
 	void interceptRequest(QWebEngineUrlRequestInfo &request) override;
-	QStringList getBlockedElements() const;
+	QSet<QString> getBlockedElements() const;
 	QVector<NetworkManager::ResourceInformation> getBlockedRequests() const;
 
 protected:
@@ -57,7 +58,7 @@ protected slots:
 
 private:
 	QtWebEngineWebWidget *m_widget;
-	QStringList m_blockedElements;
+	QSet<QString> m_blockedElements;
 	QStringList m_unblockedHosts;
 	QVector<NetworkManager::ResourceInformation> m_blockedRequests;
 	QVector<int> m_contentBlockingProfiles;
@@ -81,7 +82,7 @@ public:
 	explicit QtWebEngineUrlRequestInterceptor(QObject *parent = nullptr);
 
 	void interceptRequest(QWebEngineUrlRequestInfo &request) override;
-	QStringList getBlockedElements(const QString &domain) const;
+	QSet<QString> getBlockedElements(const QString &domain) const;
 
 protected:
 	void timerEvent(QTimerEvent *event) override;
@@ -91,7 +92,7 @@ protected slots:
 	void handleOptionChanged(int identifier);
 
 private:
-	QMap<QString, QStringList> m_blockedElements;
+	QMap<QString, QSet<QString> > m_blockedElements;
 	QMap<QString, QVector<int> > m_contentBlockingProfiles;
 	int m_clearTimer;
 	bool m_areImagesEnabled;
@@ -36,6 +36,8 @@
 
 #include <QtCore/QCoreApplication>
 #include <QtCore/QDir>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
 #include <QtCore/QRegularExpression>
 #include <QtWebEngineWidgets/QWebEngineProfile>
 #include <QtWebEngineWidgets/QWebEngineSettings>
@@ -51,6 +53,7 @@ QtWebEngineWebBackend::QtWebEngineWebBackend(QObject *parent) : WebBackend(paren
 #if QTWEBENGINECORE_VERSION < 0x050D00
 	m_requestInterceptor(nullptr),
 #endif
+	m_cosmeticFiltersScripts(m_cosmeticFiltersScriptsSize),
 	m_isInitialized(false)
 {
 	const QString userAgent(QWebEngineProfile::defaultProfile()->httpUserAgent());
@@ -141,6 +144,11 @@ void QtWebEngineWebBackend::handleDownloadRequested(QWebEngineDownloadItem *item
 	}
 }
 
+void QtWebEngineWebBackend::clearCosmeticFiltersScripts()
+{
+	m_cosmeticFiltersScripts.clear();
+}
+
 void QtWebEngineWebBackend::handleOptionChanged(int identifier)
 {
 	switch (identifier)
@@ -270,6 +278,7 @@ WebWidget* QtWebEngineWebBackend::createWidget(const QVariantMap &parameters, Co
 		handleOptionChanged(SettingsManager::Permissions_EnableFullScreenOption);
 
 		connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &QtWebEngineWebBackend::handleOptionChanged);
+		connect(ContentFiltersManager::getInstance(), &ContentFiltersManager::cacheCleared, this, &QtWebEngineWebBackend::clearCosmeticFiltersScripts);
 		connect(QWebEngineProfile::defaultProfile(), &QWebEngineProfile::downloadRequested, this, &QtWebEngineWebBackend::handleDownloadRequested);
 	}
 
@@ -327,10 +336,59 @@ QString QtWebEngineWebBackend::getUserAgent(const QString &pattern) const
 	return ((userAgent.isEmpty()) ? QString() : getUserAgent(userAgent));
 }
 
+QString QtWebEngineWebBackend::getCosmeticFiltersScript(const QVector<int> &profiles, const QUrl &url)
+{
+	QStringList keyParts;
+	keyParts.reserve(profiles.count() + 1);
+	keyParts.append(url.host());
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		keyParts.append(QString::number(profiles.at(i)));
+	}
+
+	const QString cacheKey(keyParts.join(QLatin1Char(' ')));
+	const QString *cachedScript(m_cosmeticFiltersScripts.object(cacheKey));
+
+	if (cachedScript)
+	{
+		return *cachedScript;
+	}
+
+	const QString styleSheet(ContentFiltersManager::getCosmeticFiltersStyleSheet(profiles, url));
+
+	if (styleSheet.isEmpty())
+	{
+		return {};
+	}
+
+	const QString script(QLatin1String("(function(styleSheet) { function addStyleSheet() { var element = document.createElement('style'); element.textContent = styleSheet; (document.head || document.documentElement).appendChild(element); } if (document.documentElement) { addStyleSheet(); } else { new MutationObserver(function(mutations, observer) { if (document.documentElement) { observer.disconnect(); addStyleSheet(); } }).observe(document, { childList: true }); } })(") + QString::fromUtf8(QJsonDocument(QJsonArray({styleSheet})).toJson(QJsonDocument::Compact)) + QLatin1String("[0]);"));
+	bool areProfilesLoaded(true);
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(profiles.at(i)));
+
+		if (profile && !profile->isLoaded())
+		{
+			areProfilesLoaded = false;
+
+			break;
+		}
+	}
+
+	if (areProfilesLoaded)
+	{
+		m_cosmeticFiltersScripts.insert(cacheKey, new QString(script), qMax(1, ((script.size() * static_cast<int>(sizeof(QChar))) / 1024)));
+	}
+
+	return script;
+}
+
 #if QTWEBENGINECORE_VERSION < 0x050D00
-QStringList QtWebEngineWebBackend::getBlockedElements(const QString &domain) const
+QSet<QString> QtWebEngineWebBackend::getBlockedElements(const QString &domain) const
 {
-	return (m_requestInterceptor ? m_requestInterceptor->getBlockedElements(domain) : QStringList());
+	return (m_requestInterceptor ? m_requestInterceptor->getBlockedElements(domain) : QSet<QString>());
 }
 #endif
 
@@ -23,6 +23,7 @@
 
 #include "../../../../core/WebBackend.h"
 
+#include <QtCore/QCache>
 #include <QtWebEngineCore/QtWebEngineCoreVersion>
 #if QTWEBENGINECORE_VERSION >= 0x050D00
 #include <QtWebEngineCore/QWebEngineNotification>
@@ -52,8 +53,9 @@ public:
 	QString getEngineVersion() const override;
 	QString getSslVersion() const override;
 	QString getUserAgent(const QString &pattern = {}) const override;
+	QString getCosmeticFiltersScript(const QVector<int> &profiles, const QUrl &url);
 #if QTWEBENGINECORE_VERSION < 0x050D00
-	QStringList getBlockedElements(const QString &domain) const;
+	QSet<QString> getBlockedElements(const QString &domain) const;
 #endif
 	QUrl getHomePage() const override;
 	WebBackend::BackendCapabilities getCapabilities() const override;
@@ -67,16 +69,19 @@ protected:
 protected slots:
 	void handleDownloadRequested(QWebEngineDownloadItem *item);
 	void handleOptionChanged(int identifier);
+	void clearCosmeticFiltersScripts();
 
 private:
 #if QTWEBENGINECORE_VERSION < 0x050D00
 	QtWebEngineUrlRequestInterceptor *m_requestInterceptor;
 #endif
+	QCache<QString, QString> m_cosmeticFiltersScripts;
 	bool m_isInitialized;
 
 	static QString m_engineVersion;
 	static QHash<QString, QString> m_userAgentComponents;
 	static QMap<QString, QString> m_userAgents;
+	static const int m_cosmeticFiltersScriptsSize = 32768;
 
 friend class QtWebEnginePage;
 };
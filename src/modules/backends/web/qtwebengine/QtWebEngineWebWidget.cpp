@@ -1635,7 +1635,7 @@ QDateTime QtWebEngineWebWidget::getLastUrlClickTime() const
 }
 
 #if QTWEBENGINECORE_VERSION >= 0x050D00
-QStringList QtWebEngineWebWidget::getBlockedElements() const
+QSet<QString> QtWebEngineWebWidget::getBlockedElements() const
 {
 	return m_requestInterceptor->getBlockedElements();
 }
@@ -22,6 +22,7 @@
 
 #include "../../../../ui/WebWidget.h"
 
+#include <QtCore/QSet>
 #include <QtNetwork/QNetworkReply>
 #include <QtWebEngineCore/QtWebEngineCoreVersion>
 #include <QtWebEngineWidgets/QWebEngineFullScreenRequest>
@@ -132,7 +133,7 @@ protected:
 	QString parsePosition(const QString &script, const QPoint &position) const;
 	QDateTime getLastUrlClickTime() const;
 #if QTWEBENGINECORE_VERSION >= 0x050D00
-	QStringList getBlockedElements() const;
+	QSet<QString> getBlockedElements() const;
 #endif
 	QVector<LinkUrl> processLinks(const QVariantList &rawLinks) const;
 	bool canGoBack() const override;
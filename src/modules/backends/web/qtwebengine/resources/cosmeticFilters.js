@@ -0,0 +1,102 @@
+(function(window, document)
+{
+	let knownTokens = new Set();
+	let identifiers = [];
+	let classes = [];
+	let isScheduled = false;
+
+	function collectTokens(element)
+	{
+		if (!element || element.nodeType !== Node.ELEMENT_NODE)
+		{
+			return;
+		}
+
+		if (element.id && !knownTokens.has('#' + element.id))
+		{
+			knownTokens.add('#' + element.id);
+
+			identifiers.push(element.id);
+		}
+
+		if (!element.classList)
+		{
+			return;
+		}
+
+		for (let i = 0; i < element.classList.length; ++i)
+		{
+			if (!knownTokens.has('.' + element.classList[i]))
+			{
+				knownTokens.add('.' + element.classList[i]);
+
+				classes.push(element.classList[i]);
+			}
+		}
+	}
+
+	function collectTree(root)
+	{
+		if (!root)
+		{
+			return;
+		}
+
+		collectTokens(root);
+
+		if (root.querySelectorAll)
+		{
+			let elements = root.querySelectorAll('[id], [class]');
+
+			for (let i = 0; i < elements.length; ++i)
+			{
+				collectTokens(elements[i]);
+			}
+		}
+	}
+
+	function sendTokens()
+	{
+		isScheduled = false;
+
+		if (identifiers.length === 0 && classes.length === 0)
+		{
+			return;
+		}
+
+		console.debug('%1' + JSON.stringify({ identifiers: identifiers, classes: classes }));
+
+		identifiers = [];
+		classes = [];
+	}
+
+	let observer = new MutationObserver(function(mutations)
+	{
+		for (let i = 0; i < mutations.length; ++i)
+		{
+			if (mutations[i].type === 'attributes')
+			{
+				collectTokens(mutations[i].target);
+
+				continue;
+			}
+
+			for (let j = 0; j < mutations[i].addedNodes.length; ++j)
+			{
+				collectTree(mutations[i].addedNodes[j]);
+			}
+		}
+
+		if (!isScheduled && (identifiers.length > 0 || classes.length > 0))
+		{
+			isScheduled = true;
+
+			window.setTimeout(sendTokens, 50);
+		}
+	});
+
+	collectTree(document.documentElement);
+	sendTokens();
+
+	observer.observe(document, { childList: true, subtree: true, attributes: true, attributeFilter: ['id', 'class'] });
+})(window, document);
@@ -1,13 +1,21 @@
-let requests = [%1];
-let elements = Array.from(document.querySelectorAll('[src]'));
+let requests = %1;
+let elements = document.querySelectorAll('[src]');
 
 for (let i = 0; i < elements.length; ++i)
 {
-	for (let j = 0; j < requests.length; ++j)
+	let url = '';
+
+	try
+	{
+		url = new URL(elements[i].getAttribute('src'), document.baseURI).href.split('#')[0];
+	}
+	catch (e)
+	{
+		continue;
+	}
+
+	if (Object.prototype.hasOwnProperty.call(requests, url))
 	{
-		if (elements[i].getAttribute('src').indexOf(requests[j]) > -1)
-		{
-			elements[i].style.cssText = 'display:none !important';
-		}
+		elements[i].style.cssText = 'display:none !important';
 	}
 }
@@ -46,6 +46,7 @@
 #include <QtCore/QMimeDatabase>
 #include <QtNetwork/QNetworkProxy>
 #include <QtNetwork/QNetworkReply>
+#include <QtWebKitWidgets/QWebFrame>
 
 namespace Otter
 {
@@ -567,6 +568,8 @@ QtWebKitNetworkManager* QtWebKitNetworkManager::clone() const
 
 QNetworkReply* QtWebKitNetworkManager::createRequest(Operation operation, const QNetworkRequest &request, QIODevice *outgoingData)
 {
+	const SettingsManager::ProfilingScope profilingScope(SettingsManager::NetworkSubsystem);
+
 	if (m_widget && request.url() == m_formRequestUrl)
 	{
 		m_formRequestUrl = QUrl();
@@ -578,9 +581,23 @@ QNetworkReply* QtWebKitNetworkManager::createRequest(Operation operation, const
 
 	if (m_widget && request.url().path() == QLatin1String("/otter-message") && request.hasRawHeader(QByteArrayLiteral("X-Otter-Token")) && request.hasRawHeader(QByteArrayLiteral("X-Otter-Data")))
 	{
-		if (QString::fromLatin1(request.rawHeader(QByteArrayLiteral("X-Otter-Token"))) == m_widget->getMessageToken())
+		const QString token(QString::fromLatin1(request.rawHeader(QByteArrayLiteral("X-Otter-Token"))));
+		const QString type(QString::fromLatin1(request.rawHeader(QByteArrayLiteral("X-Otter-Type"))));
+
+		if (type == QLatin1String("cosmetic-filters-tokens") && token == m_widget->getCosmeticFiltersToken())
+		{
+			QWebFrame *frame(qobject_cast<QWebFrame*>(request.originatingObject()));
+			QtWebKitPage *page(frame ? qobject_cast<QtWebKitPage*>(frame->page()) : nullptr);
+
+			if (page)
+			{
+				const QJsonObject payloadObject(QJsonDocument::fromJson(QByteArray::fromBase64(request.rawHeader(QByteArrayLiteral("X-Otter-Data")))).object());
+
+				page->applyCosmeticFilters(frame, payloadObject.value(QLatin1String("identifiers")).toVariant().toStringList(), payloadObject.value(QLatin1String("classes")).toVariant().toStringList());
+			}
+		}
+		else if (token == m_widget->getMessageToken())
 		{
-			const QString type(QString::fromLatin1(request.rawHeader(QByteArrayLiteral("X-Otter-Type"))));
 			const QJsonObject payloadObject(QJsonDocument::fromJson(QByteArray::fromBase64(request.rawHeader(QByteArrayLiteral("X-Otter-Data")))).object());
 
 			if (type == QLatin1String("add-ssl-error-exception"))
@@ -665,11 +682,11 @@ QNetworkReply* QtWebKitNetworkManager::createRequest(Operation operation, const
 			{
 				const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(result.profile));
 
-				Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg((profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), result.rule), Console::NetworkCategory, Console::LogLevel, request.url().toString(), -1, (m_widget ? m_widget->getWindowIdentifier() : 0));
+				Console::addBlockedRequest(request.url(), result.rule, (profile ? profile->getName() : QString()), (m_widget ? m_widget->getWindowIdentifier() : 0));
 
 				if (resourceType != NetworkManager::ScriptType && resourceType != NetworkManager::StyleSheetType)
 				{
-					m_blockedElements.append(request.url().url());
+					m_blockedElements.insert(request.url().adjusted(QUrl::RemoveFragment).toString(QUrl::FullyEncoded));
 				}
 
 				NetworkManager::ResourceInformation resource;
@@ -829,7 +846,7 @@ WebWidget::SslInformation QtWebKitNetworkManager::getSslInformation() const
 	return m_sslInformation;
 }
 
-QStringList QtWebKitNetworkManager::getBlockedElements() const
+QSet<QString> QtWebKitNetworkManager::getBlockedElements() const
 {
 	return m_blockedElements;
 }
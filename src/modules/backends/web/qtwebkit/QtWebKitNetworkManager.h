@@ -45,7 +45,7 @@ public:
 	CookieJar* getCookieJar() const;
 	QVariant getPageInformation(WebWidget::PageInformation key) const;
 	WebWidget::SslInformation getSslInformation() const;
-	QStringList getBlockedElements() const;
+	QSet<QString> getBlockedElements() const;
 	QVector<NetworkManager::ResourceInformation> getBlockedRequests() const;
 	QMap<QByteArray, QByteArray> getHeaders() const;
 	WebWidget::ContentStates getContentState() const;
@@ -86,7 +86,7 @@ private:
 	QUrl m_formRequestUrl;
 	QUrl m_mainRequestUrl;
 	WebWidget::SslInformation m_sslInformation;
-	QStringList m_blockedElements;
+	QSet<QString> m_blockedElements;
 	QStringList m_unblockedHosts;
 	QVector<QNetworkReply*> m_transfers;
 	QVector<NetworkManager::ResourceInformation> m_blockedRequests;
@@ -35,6 +35,7 @@
 
 #include <QtCore/QFile>
 #include <QtCore/QFileInfo>
+#include <QtCore/QSet>
 #include <QtGui/QGuiApplication>
 #include <QtGui/QWheelEvent>
 #include <QtWebKit/QWebHistory>
@@ -50,6 +51,7 @@ QtWebKitFrame::QtWebKitFrame(QWebFrame *frame, QtWebKitWebWidget *parent) : QObj
 	m_isDisplayingErrorPage(false)
 {
 	connect(frame, &QWebFrame::destroyed, this, &QtWebKitFrame::deleteLater);
+	connect(frame, &QWebFrame::initialLayoutCompleted, this, &QtWebKitFrame::handleInitialLayoutCompleted);
 	connect(frame, &QWebFrame::loadFinished, this, &QtWebKitFrame::handleLoadFinished);
 }
 
@@ -63,27 +65,28 @@ void QtWebKitFrame::runUserScripts(const QUrl &url) const
 	}
 }
 
-void QtWebKitFrame::applyContentBlockingRules(const QStringList &rules, bool isHiding)
+void QtWebKitFrame::handleIsDisplayingErrorPageChanged(QWebFrame *frame, bool isDisplayingErrorPage)
 {
-	const QString value(isHiding ? QLatin1String("none !important") : QString());
-	const QWebElementCollection elements(m_frame->documentElement().findAll(rules.join(QLatin1Char(','))));
-
-	for (int i = 0; i < elements.count(); ++i)
+	if (frame == m_frame)
 	{
-		QWebElement element(elements.at(i));
-
-		if (!element.isNull())
-		{
-			element.setStyleProperty(QLatin1String("display"), value);
-		}
+		m_isDisplayingErrorPage = isDisplayingErrorPage;
 	}
 }
 
-void QtWebKitFrame::handleIsDisplayingErrorPageChanged(QWebFrame *frame, bool isDisplayingErrorPage)
+void QtWebKitFrame::handleInitialLayoutCompleted()
 {
-	if (frame == m_frame)
+	if (!m_widget || !m_frame->page()->settings()->testAttribute(QWebSettings::JavascriptEnabled) || !m_widget->getOption(SettingsManager::ContentBlocking_EnableContentBlockingOption).toBool() || m_widget->getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList().isEmpty())
 	{
-		m_isDisplayingErrorPage = isDisplayingErrorPage;
+		return;
+	}
+
+	QFile file(QLatin1String(":/modules/backends/web/qtwebkit/resources/cosmeticFilters.js"));
+
+	if (file.open(QIODevice::ReadOnly))
+	{
+		m_frame->evaluateJavaScript(QString::fromLatin1(file.readAll()).arg(m_widget->getCosmeticFiltersToken()));
+
+		file.close();
 	}
 }
 
@@ -126,30 +129,50 @@ void QtWebKitFrame::handleLoadFinished()
 		return;
 	}
 
-	const ContentFiltersManager::CosmeticFiltersResult cosmeticFilters(ContentFiltersManager::getCosmeticFilters(ContentFiltersManager::getProfileIdentifiers(m_widget->getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList()), m_widget->getUrl()));
+	QtWebKitPage *page(qobject_cast<QtWebKitPage*>(m_frame->page()));
+
+	if (page && !page->settings()->testAttribute(QWebSettings::JavascriptEnabled))
+	{
+		const QWebElementCollection elements(m_frame->findAllElements(QLatin1String("[id], [class]")));
+		QSet<QString> identifiers;
+		QSet<QString> classes;
+
+		for (int i = 0; i < elements.count(); ++i)
+		{
+			const QWebElement element(elements.at(i));
+			const QString identifier(element.attribute(QLatin1String("id")));
+
+			if (!identifier.isEmpty())
+			{
+				identifiers.insert(identifier);
+			}
+
+			const QStringList elementClasses(element.classes());
+
+			for (int j = 0; j < elementClasses.count(); ++j)
+			{
+				classes.insert(elementClasses.at(j));
+			}
+		}
 
-	applyContentBlockingRules(cosmeticFilters.rules, true);
-	applyContentBlockingRules(cosmeticFilters.exceptions, false);
+		page->applyCosmeticFilters(m_frame, identifiers.toList(), classes.toList());
+	}
 
-	const QStringList blockedRequests(m_widget->getBlockedElements());
+	const QSet<QString> blockedRequests(m_widget->getBlockedElements());
 
-	if (blockedRequests.count() > 0)
+	if (!blockedRequests.isEmpty())
 	{
+		const QUrl baseUrl(m_frame->baseUrl());
 		const QWebElementCollection elements(m_frame->documentElement().findAll(QLatin1String("[src]")));
 
 		for (int i = 0; i < elements.count(); ++i)
 		{
 			QWebElement element(elements.at(i));
-			const QUrl url(element.attribute(QLatin1String("src")));
+			const QUrl url(baseUrl.resolved(QUrl(element.attribute(QLatin1String("src")))));
 
-			for (int j = 0; j < blockedRequests.count(); ++j)
+			if (blockedRequests.contains(url.adjusted(QUrl::RemoveFragment).toString(QUrl::FullyEncoded)))
 			{
-				if (url.matches(QUrl(blockedRequests.at(j)), QUrl::None) || blockedRequests.at(j).endsWith(url.url()))
-				{
-					element.setStyleProperty(QLatin1String("display"), QLatin1String("none !important"));
-
-					break;
-				}
+				element.setStyleProperty(QLatin1String("display"), QLatin1String("none !important"));
 			}
 		}
 	}
@@ -226,6 +249,33 @@ QtWebKitPage::~QtWebKitPage()
 	m_popups.clear();
 }
 
+void QtWebKitPage::applyCosmeticFilters(QWebFrame *frame, const QStringList &identifiers, const QStringList &classes)
+{
+	if (!getOption(SettingsManager::ContentBlocking_EnableContentBlockingOption).toBool())
+	{
+		return;
+	}
+
+	QString styleSheet(ContentFiltersManager::getCosmeticFiltersStyleSheet(ContentFiltersManager::getProfileIdentifiers(getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList()), (frame->url().host().isEmpty() ? mainFrame()->url() : frame->url()), identifiers, classes));
+
+	if (styleSheet.isEmpty())
+	{
+		return;
+	}
+
+	QWebElement element(frame->findFirstElement(QLatin1String("head")));
+
+	if (element.isNull())
+	{
+		element = frame->documentElement();
+	}
+
+	if (!element.isNull())
+	{
+		element.appendInside(QLatin1String("<style>") + styleSheet.replace(QLatin1String("</"), QLatin1String("<\\/")) + QLatin1String("</style>"));
+	}
+}
+
 void QtWebKitPage::validatePopup(const QUrl &url)
 {
 	QtWebKitPage *page(qobject_cast<QtWebKitPage*>(sender()));
@@ -245,7 +295,7 @@ void QtWebKitPage::validatePopup(const QUrl &url)
 
 		if (result.isBlocked)
 		{
-			Console::addMessage(QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg(ContentFiltersManager::getProfile(result.profile)->getTitle(), result.rule), Console::NetworkCategory, Console::LogLevel, url.url(), -1, (m_widget ? m_widget->getWindowIdentifier() : 0));
+			Console::addBlockedRequest(url, result.rule, ContentFiltersManager::getProfile(result.profile)->getName(), (m_widget ? m_widget->getWindowIdentifier() : 0));
 
 			return;
 		}
@@ -384,6 +434,11 @@ void QtWebKitPage::updateStyleSheets(const QUrl &url)
 		styleSheet.append(QLatin1String("body::-webkit-scrollbar {display:none;}"));
 	}
 
+	if (getOption(SettingsManager::ContentBlocking_EnableContentBlockingOption).toBool())
+	{
+		styleSheet.append(ContentFiltersManager::getCosmeticFiltersStyleSheet(ContentFiltersManager::getProfileIdentifiers(getOption(SettingsManager::ContentBlocking_ProfilesOption).toStringList()), (url.isEmpty() ? mainFrame()->url() : url)));
+	}
+
 	const QString userSyleSheetPath(getOption(SettingsManager::Content_UserStyleSheetOption).toString());
 
 	if (!userSyleSheetPath.isEmpty())
@@ -47,10 +47,8 @@ public:
 public slots:
 	void handleIsDisplayingErrorPageChanged(QWebFrame *frame, bool isDisplayingErrorPage);
 
-protected:
-	void applyContentBlockingRules(const QStringList &rules, bool isHiding);
-
 protected slots:
+	void handleInitialLayoutCompleted();
 	void handleLoadFinished();
 
 private:
@@ -67,6 +65,7 @@ public:
 	explicit QtWebKitPage(QtWebKitNetworkManager *networkManager, QtWebKitWebWidget *parent);
 	~QtWebKitPage();
 
+	void applyCosmeticFilters(QWebFrame *frame, const QStringList &identifiers, const QStringList &classes);
 	void triggerAction(WebAction action, bool isChecked = false) override;
 	QtWebKitFrame* getMainFrame() const;
 	QVariant runScript(const QString &path, QWebElement element = {});
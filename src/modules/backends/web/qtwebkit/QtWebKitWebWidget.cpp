@@ -28,6 +28,7 @@
 #include "../../../../core/Console.h"
 #include "../../../../core/CookieJar.h"
 #include "../../../../core/ContentFiltersManager.h"
+#include "../../../../core/FaviconsManager.h"
 #include "../../../../core/GesturesManager.h"
 #include "../../../../core/HistoryManager.h"
 #include "../../../../core/JsonSettings.h"
@@ -1422,6 +1423,7 @@ void QtWebKitWebWidget::handleLoadStarted()
 	}
 
 	m_thumbnail = {};
+	m_cosmeticFiltersToken = QUuid::createUuid().toString();
 	m_messageToken = QUuid::createUuid().toString();
 	m_canLoadPlugins = (getOption(SettingsManager::Permissions_EnablePluginsOption, getUrl()).toString() == QLatin1String("enabled"));
 	m_loadingState = OngoingLoadingState;
@@ -2071,6 +2073,11 @@ QString QtWebKitWebWidget::getSelectedText() const
 	return m_page->selectedText();
 }
 
+QString QtWebKitWebWidget::getCosmeticFiltersToken() const
+{
+	return m_cosmeticFiltersToken;
+}
+
 QString QtWebKitWebWidget::getMessageToken() const
 {
 	return m_messageToken;
@@ -2309,12 +2316,7 @@ Session::Window::History QtWebKitWebWidget::getHistory() const
 
 		if (identifier > 0)
 		{
-			const HistoryModel::Entry *globalEntry(HistoryManager::getEntry(identifier));
-
-			if (globalEntry)
-			{
-				entry.icon = globalEntry->icon();
-			}
+			entry.icon = FaviconsManager::getIcon(HistoryManager::getEntry(identifier).url);
 		}
 
 		history.entries.append(entry);
@@ -2446,7 +2448,7 @@ WebWidget::HitTestResult QtWebKitWebWidget::getHitTestResult(const QPoint &posit
 	return result;
 }
 
-QStringList QtWebKitWebWidget::getBlockedElements() const
+QSet<QString> QtWebKitWebWidget::getBlockedElements() const
 {
 	return m_networkManager->getBlockedElements();
 }
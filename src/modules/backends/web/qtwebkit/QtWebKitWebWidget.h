@@ -24,6 +24,7 @@
 #include "../../../../ui/WebWidget.h"
 
 #include <QtCore/QQueue>
+#include <QtCore/QSet>
 #include <QtNetwork/QNetworkReply>
 #include <QtWebKitWidgets/QWebInspector>
 #include <QtWebKitWidgets/QWebPage>
@@ -65,7 +66,7 @@ public:
 	QString getActiveStyleSheet() const override;
 	QString getSelectedText() const override;
 	QVariant getPageInformation(PageInformation key) const override;
-	QStringList getBlockedElements() const;
+	QSet<QString> getBlockedElements() const;
 	QUrl getUrl() const override;
 	QIcon getIcon() const override;
 	QPixmap createThumbnail(const QSize &size = {}) override;
@@ -135,6 +136,7 @@ protected:
 	void setHistory(const QVariantMap &history);
 	void setOptions(const QHash<int, QVariant> &options, const QStringList &excludedOptions = {}) override;
 	QtWebKitPage* getPage() const;
+	QString getCosmeticFiltersToken() const;
 	QString getMessageToken() const;
 	QString getPluginToken() const;
 	QUrl resolveUrl(QWebFrame *frame, const QUrl &url) const;
@@ -182,6 +184,7 @@ private:
 	QtWebKitPage *m_page;
 	QtWebKitInspectorWidget *m_inspectorWidget;
 	QtWebKitNetworkManager *m_networkManager;
+	QString m_cosmeticFiltersToken;
 	QString m_messageToken;
 	QString m_pluginToken;
 	QPixmap m_thumbnail;
@@ -0,0 +1,111 @@
+(function(window, document)
+{
+	var knownTokens = {};
+	var identifiers = [];
+	var classes = [];
+	var isScheduled = false;
+
+	function collectTokens(element)
+	{
+		if (!element || element.nodeType !== 1)
+		{
+			return;
+		}
+
+		if (element.id && !knownTokens['#' + element.id])
+		{
+			knownTokens['#' + element.id] = true;
+
+			identifiers.push(element.id);
+		}
+
+		var classList = element.classList;
+
+		if (!classList)
+		{
+			return;
+		}
+
+		for (var i = 0; i < classList.length; ++i)
+		{
+			if (!knownTokens['.' + classList[i]])
+			{
+				knownTokens['.' + classList[i]] = true;
+
+				classes.push(classList[i]);
+			}
+		}
+	}
+
+	function collectTree(root)
+	{
+		collectTokens(root);
+
+		if (root.querySelectorAll)
+		{
+			var elements = root.querySelectorAll('[id], [class]');
+
+			for (var i = 0; i < elements.length; ++i)
+			{
+				collectTokens(elements[i]);
+			}
+		}
+	}
+
+	function sendTokens()
+	{
+		isScheduled = false;
+
+		if (identifiers.length === 0 && classes.length === 0)
+		{
+			return;
+		}
+
+		var request = new XMLHttpRequest();
+		request.open('GET', '/otter-message', true);
+		request.setRequestHeader('X-Otter-Token', '%1');
+		request.setRequestHeader('X-Otter-Type', 'cosmetic-filters-tokens');
+		request.setRequestHeader('X-Otter-Data', btoa(unescape(encodeURIComponent(JSON.stringify({ identifiers: identifiers, classes: classes })))));
+		request.send(null);
+
+		identifiers = [];
+		classes = [];
+	}
+
+	function scheduleTokens()
+	{
+		if (!isScheduled && (identifiers.length > 0 || classes.length > 0))
+		{
+			isScheduled = true;
+
+			window.setTimeout(sendTokens, 50);
+		}
+	}
+
+	var observer = new MutationObserver(function(mutations)
+	{
+		for (var i = 0; i < mutations.length; ++i)
+		{
+			var mutation = mutations[i];
+
+			if (mutation.type === 'attributes')
+			{
+				collectTokens(mutation.target);
+
+				continue;
+			}
+
+			for (var j = 0; j < mutation.addedNodes.length; ++j)
+			{
+				collectTree(mutation.addedNodes[j]);
+			}
+		}
+
+		scheduleTokens();
+	});
+
+	collectTree(document.documentElement);
+	sendTokens();
+
+	observer.observe(document, { childList: true, subtree: true, attributes: true, attributeFilter: ['id', 'class'] });
+})(window, document);
@@ -19,6 +19,7 @@
 
 #include "ErrorConsoleWidget.h"
 #include "../../../core/Application.h"
+#include "../../../core/ContentFiltersManager.h"
 #include "../../../core/ThemesManager.h"
 #include "../../../ui/MainWindow.h"
 #include "../../../ui/Window.h"
@@ -116,16 +117,12 @@ void ErrorConsoleWidget::showEvent(QShowEvent *event)
 		m_model = new QStandardItemModel(this);
 		m_model->setSortRole(TimeRole);
 
-		const QVector<Console::Message> messages(Console::getMessages());
-
-		for (int i = 0; i < messages.count(); ++i)
-		{
-			addMessage(messages.at(i));
-		}
+		addMessages(Console::getMessages());
 
 		m_ui->consoleView->setModel(m_model);
 
 		connect(Console::getInstance(), &Console::messageAdded, this, &ErrorConsoleWidget::addMessage);
+		connect(Console::getInstance(), &Console::messagesAdded, this, &ErrorConsoleWidget::addMessages);
 	}
 
 	QWidget::showEvent(event);
@@ -133,11 +130,30 @@ void ErrorConsoleWidget::showEvent(QShowEvent *event)
 
 void ErrorConsoleWidget::addMessage(const Console::Message &message)
 {
-	if (!m_model)
+	addMessages({message});
+}
+
+void ErrorConsoleWidget::addMessages(const QVector<Console::Message> &messages)
+{
+	if (!m_model || messages.isEmpty())
 	{
 		return;
 	}
 
+	const QString filter(m_ui->filterLineEditWidget->text());
+	const QVector<Console::MessageCategory> categories(getCategories());
+	const quint64 activeWindow(getActiveWindow());
+
+	for (int i = 0; i < messages.count(); ++i)
+	{
+		applyFilters(appendMessage(messages.at(i))->index(), filter, categories, activeWindow);
+	}
+
+	m_model->sort(0, Qt::DescendingOrder);
+}
+
+QStandardItem* ErrorConsoleWidget::appendMessage(const Console::Message &message)
+{
 	QIcon icon;
 	QString category;
 
@@ -178,7 +194,15 @@ void ErrorConsoleWidget::addMessage(const Console::Message &message)
 	}
 
 	const QString source(message.source + ((message.line > 0) ? QStringLiteral(":%1").arg(message.line) : QString()));
-	const QString description(message.note.isEmpty() ? tr("<empty>") : message.note);
+	QString description(message.note.isEmpty() ? tr("<empty>") : message.note);
+
+	if (!message.profile.isEmpty())
+	{
+		const ContentFiltersProfile *profile(ContentFiltersManager::getProfile(message.profile));
+
+		description = QCoreApplication::translate("main", "Request blocked by rule from profile %1:\n%2").arg((profile ? profile->getTitle() : QCoreApplication::translate("main", "(Unknown)")), message.note);
+	}
+
 	QString entry(QStringLiteral("[%1] %2").arg(message.time.toLocalTime().toString(QLatin1String("yyyy-dd-MM hh:mm:ss")), category));
 
 	if (!message.source.isEmpty())
@@ -200,9 +224,8 @@ void ErrorConsoleWidget::addMessage(const Console::Message &message)
 	messageItem->appendRow(descriptionItem);
 
 	m_model->appendRow(messageItem);
-	m_model->sort(0, Qt::DescendingOrder);
 
-	applyFilters(messageItem->index(), m_ui->filterLineEditWidget->text(), getCategories(), getActiveWindow());
+	return messageItem;
 }
 
 void ErrorConsoleWidget::filterCategories()
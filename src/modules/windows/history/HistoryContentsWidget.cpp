@@ -19,6 +19,7 @@
 
 #include "HistoryContentsWidget.h"
 #include "../../../core/Application.h"
+#include "../../../core/FaviconsManager.h"
 #include "../../../core/ThemesManager.h"
 #include "../../../core/Utils.h"
 #include "../../../ui/Action.h"
@@ -31,6 +32,8 @@
 #include <QtGui/QMouseEvent>
 #include <QtWidgets/QMenu>
 
+#include <algorithm>
+
 namespace Otter
 {
 
@@ -70,8 +73,9 @@ HistoryContentsWidget::HistoryContentsWidget(const QVariantMap &parameters, Wind
 	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::cleared, this, &HistoryContentsWidget::populateEntries);
 	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::entryAdded, this, &HistoryContentsWidget::handleEntryAdded);
 	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::entryModified, this, &HistoryContentsWidget::handleEntryModified);
-	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::entryRemoved, this, &HistoryContentsWidget::handleEntryRemoved);
+	connect(HistoryManager::getBrowsingHistoryModel(), &HistoryModel::entriesRemoved, this, &HistoryContentsWidget::handleEntriesRemoved);
 	connect(HistoryManager::getInstance(), &HistoryManager::dayChanged, this, &HistoryContentsWidget::populateEntries);
+	connect(FaviconsManager::getInstance(), &FaviconsManager::iconChanged, this, &HistoryContentsWidget::handleIconChanged);
 	connect(m_ui->filterLineEditWidget, &LineEditWidget::textChanged, m_ui->historyViewWidget, &ItemViewWidget::setFilterString);
 	connect(m_ui->historyViewWidget, &ItemViewWidget::doubleClicked, this, &HistoryContentsWidget::openEntry);
 	connect(m_ui->historyViewWidget, &ItemViewWidget::customContextMenuRequested, this, &HistoryContentsWidget::showContextMenu);
@@ -124,6 +128,9 @@ void HistoryContentsWidget::populateEntries()
 	const QDate date(QDate::currentDate());
 	const QVector<QDate> dates({date, date.addDays(-1), date.addDays(-7), date.addDays(-14), date.addDays(-30), date.addDays(-365)});
 
+	m_entries.clear();
+	m_urls.clear();
+
 	for (int i = 0; i < m_model->rowCount(); ++i)
 	{
 		QStandardItem *groupItem(m_model->item(i, 0));
@@ -139,7 +146,7 @@ void HistoryContentsWidget::populateEntries()
 
 	for (int i = 0; i < model->rowCount(); ++i)
 	{
-		handleEntryAdded(static_cast<HistoryModel::Entry*>(model->item(i, 0)));
+		handleEntryAdded(model->getEntry(model->index(i, 0).data(HistoryModel::IdentifierRole).toULongLong()));
 	}
 
 	const QString expandBranches(SettingsManager::getOption(SettingsManager::History_ExpandBranchesOption).toString());
@@ -256,9 +263,9 @@ void HistoryContentsWidget::copyEntryLink()
 	}
 }
 
-void HistoryContentsWidget::handleEntryAdded(HistoryModel::Entry *entry)
+void HistoryContentsWidget::handleEntryAdded(const HistoryModel::Entry &entry)
 {
-	if (!entry || entry->getIdentifier() == 0 || findEntry(entry->getIdentifier()))
+	if (!entry.isValid() || m_entries.contains(entry.identifier))
 	{
 		return;
 	}
@@ -271,7 +278,7 @@ void HistoryContentsWidget::handleEntryAdded(HistoryModel::Entry *entry)
 
 		const QDate date(groupItem ? groupItem->data(GroupDateRole).toDate() : QDate());
 
-		if (!date.isValid() || entry->getTimeVisited().date() >= date)
+		if (!date.isValid() || entry.timeVisited.date() >= date)
 		{
 			break;
 		}
@@ -284,16 +291,20 @@ void HistoryContentsWidget::handleEntryAdded(HistoryModel::Entry *entry)
 		return;
 	}
 
-	QList<QStandardItem*> entryItems({new QStandardItem(entry->getIcon(), entry->getUrl().toDisplayString().replace(QLatin1String("%23"), QString(QLatin1Char('#')))), new QStandardItem(entry->getTitle()), new QStandardItem(Utils::formatDateTime(entry->getTimeVisited()))});
-	entryItems[0]->setData(entry->getIdentifier(), IdentifierRole);
+	QList<QStandardItem*> entryItems({new QStandardItem(entry.getIcon(), entry.url.toDisplayString().replace(QLatin1String("%23"), QString(QLatin1Char('#')))), new QStandardItem(entry.getTitle()), new QStandardItem(Utils::formatDateTime(entry.timeVisited))});
+	entryItems[0]->setData(entry.identifier, IdentifierRole);
+	entryItems[0]->setData(Utils::normalizeUrl(entry.url), UrlRole);
 	entryItems[0]->setFlags(entryItems[0]->flags() | Qt::ItemNeverHasChildren);
 	entryItems[1]->setFlags(entryItems[1]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[2]->setData(entry->getTimeVisited(), TimeVisitedRole);
+	entryItems[2]->setData(entry.timeVisited, TimeVisitedRole);
 	entryItems[2]->setFlags(entryItems[2]->flags() | Qt::ItemNeverHasChildren);
-	entryItems[2]->setToolTip(Utils::formatDateTime(entry->getTimeVisited(), {}, false));
+	entryItems[2]->setToolTip(Utils::formatDateTime(entry.timeVisited, {}, false));
 
 	groupItem->appendRow(entryItems);
 
+	m_entries[entry.identifier] = entryItems[0];
+	m_urls[Utils::normalizeUrl(entry.url)].append(entryItems[0]);
+
 	m_ui->historyViewWidget->setRowHidden(groupItem->row(), groupItem->index().parent(), false);
 
 	if (sender() && groupItem->rowCount() == 1 && SettingsManager::getOption(SettingsManager::History_ExpandBranchesOption).toString() == QLatin1String("first"))
@@ -312,14 +323,14 @@ void HistoryContentsWidget::handleEntryAdded(HistoryModel::Entry *entry)
 	}
 }
 
-void HistoryContentsWidget::handleEntryModified(HistoryModel::Entry *entry)
+void HistoryContentsWidget::handleEntryModified(const HistoryModel::Entry &entry)
 {
-	if (!entry || entry->getIdentifier() == 0)
+	if (!entry.isValid())
 	{
 		return;
 	}
 
-	QStandardItem *entryItem(findEntry(entry->getIdentifier()));
+	QStandardItem *entryItem(findEntry(entry.identifier));
 
 	if (!entryItem)
 	{
@@ -328,37 +339,91 @@ void HistoryContentsWidget::handleEntryModified(HistoryModel::Entry *entry)
 		return;
 	}
 
-	entryItem->setIcon(entry->getIcon());
-	entryItem->setText(entry->getUrl().toDisplayString());
-	entryItem->parent()->child(entryItem->row(), 1)->setText(entry->getTitle());
-	entryItem->parent()->child(entryItem->row(), 2)->setText(Utils::formatDateTime(entry->getTimeVisited()));
+	const QUrl url(Utils::normalizeUrl(entry.url));
+	const QUrl previousUrl(entryItem->data(UrlRole).toUrl());
+
+	if (url != previousUrl)
+	{
+		removeUrl(previousUrl, entryItem);
+
+		m_urls[url].append(entryItem);
+	}
+
+	entryItem->setIcon(entry.getIcon());
+	entryItem->setData(url, UrlRole);
+	entryItem->setText(entry.url.toDisplayString());
+	entryItem->parent()->child(entryItem->row(), 1)->setText(entry.getTitle());
+	entryItem->parent()->child(entryItem->row(), 2)->setText(Utils::formatDateTime(entry.timeVisited));
 }
 
-void HistoryContentsWidget::handleEntryRemoved(HistoryModel::Entry *entry)
+void HistoryContentsWidget::handleEntriesRemoved(const QVector<quint64> &identifiers)
 {
-	if (!entry || entry->getIdentifier() == 0)
+	QHash<QStandardItem*, QVector<int> > groupRows;
+
+	for (int i = 0; i < identifiers.count(); ++i)
 	{
-		return;
+		QStandardItem *entryItem(m_entries.take(identifiers.at(i)));
+
+		if (entryItem)
+		{
+			removeUrl(entryItem->data(UrlRole).toUrl(), entryItem);
+		}
+
+		if (entryItem && entryItem->parent())
+		{
+			groupRows[entryItem->parent()].append(entryItem->row());
+		}
 	}
 
-	QStandardItem *entryItem(findEntry(entry->getIdentifier()));
+	QHash<QStandardItem*, QVector<int> >::iterator iterator;
 
-	if (entryItem)
+	for (iterator = groupRows.begin(); iterator != groupRows.end(); ++iterator)
 	{
-		QStandardItem *groupItem(entryItem->parent());
+		QStandardItem *groupItem(iterator.key());
+		QVector<int> &rows(iterator.value());
 
-		if (groupItem)
+		std::sort(rows.begin(), rows.end());
+
+		int last(rows.count() - 1);
+
+		while (last >= 0)
 		{
-			m_model->removeRow(entryItem->row(), groupItem->index());
+			int first(last);
 
-			if (groupItem->rowCount() == 0)
+			while (first > 0 && rows.at(first - 1) == (rows.at(first) - 1))
 			{
-				m_ui->historyViewWidget->setRowHidden(groupItem->row(), m_model->invisibleRootItem()->index(), true);
+				--first;
 			}
+
+			groupItem->removeRows(rows.at(first), (last - first + 1));
+
+			last = (first - 1);
+		}
+
+		if (groupItem->rowCount() == 0)
+		{
+			m_ui->historyViewWidget->setRowHidden(groupItem->row(), m_model->invisibleRootItem()->index(), true);
 		}
 	}
 }
 
+void HistoryContentsWidget::handleIconChanged(const QUrl &url)
+{
+	const QVector<QStandardItem*> entryItems(m_urls.value(Utils::normalizeUrl(url)));
+
+	if (entryItems.isEmpty())
+	{
+		return;
+	}
+
+	const QIcon icon(HistoryManager::getIcon(url));
+
+	for (int i = 0; i < entryItems.count(); ++i)
+	{
+		entryItems.at(i)->setIcon(icon);
+	}
+}
+
 void HistoryContentsWidget::showContextMenu(const QPoint &position)
 {
 	MainWindow *mainWindow(MainWindow::findMainWindow(this));
@@ -385,27 +450,24 @@ void HistoryContentsWidget::showContextMenu(const QPoint &position)
 	menu.exec(m_ui->historyViewWidget->mapToGlobal(position));
 }
 
-QStandardItem* HistoryContentsWidget::findEntry(quint64 identifier)
+void HistoryContentsWidget::removeUrl(const QUrl &url, QStandardItem *entryItem)
 {
-	for (int i = 0; i < m_model->rowCount(); ++i)
+	if (!m_urls.contains(url))
 	{
-		const QStandardItem *groupItem(m_model->item(i, 0));
+		return;
+	}
 
-		if (groupItem)
-		{
-			for (int j = 0; j < groupItem->rowCount(); ++j)
-			{
-				QStandardItem *entryItem(groupItem->child(j, 0));
+	m_urls[url].removeAll(entryItem);
 
-				if (entryItem && entryItem->data(IdentifierRole).toULongLong() == identifier)
-				{
-					return entryItem;
-				}
-			}
-		}
+	if (m_urls[url].isEmpty())
+	{
+		m_urls.remove(url);
 	}
+}
 
-	return nullptr;
+QStandardItem* HistoryContentsWidget::findEntry(quint64 identifier)
+{
+	return m_entries.value(identifier);
 }
 
 QString HistoryContentsWidget::getTitle() const
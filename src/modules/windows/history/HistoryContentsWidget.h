@@ -44,7 +44,8 @@ public:
 	{
 		IdentifierRole = Qt::UserRole,
 		TimeVisitedRole,
-		GroupDateRole
+		GroupDateRole,
+		UrlRole
 	};
 
 	explicit HistoryContentsWidget(const QVariantMap &parameters, Window *window, QWidget *parent);
@@ -63,6 +64,7 @@ public slots:
 
 protected:
 	void changeEvent(QEvent *event) override;
+	void removeUrl(const QUrl &url, QStandardItem *entryItem);
 	QStandardItem* findEntry(quint64 identifier);
 	quint64 getEntry(const QModelIndex &index) const;
 
@@ -73,13 +75,16 @@ protected slots:
 	void openEntry();
 	void bookmarkEntry();
 	void copyEntryLink();
-	void handleEntryAdded(HistoryModel::Entry *entry);
-	void handleEntryModified(HistoryModel::Entry *entry);
-	void handleEntryRemoved(HistoryModel::Entry *entry);
+	void handleEntryAdded(const HistoryModel::Entry &entry);
+	void handleEntryModified(const HistoryModel::Entry &entry);
+	void handleEntriesRemoved(const QVector<quint64> &identifiers);
+	void handleIconChanged(const QUrl &url);
 	void showContextMenu(const QPoint &position);
 
 private:
 	QStandardItemModel *m_model;
+	QHash<quint64, QStandardItem*> m_entries;
+	QHash<QUrl, QVector<QStandardItem*> > m_urls;
 	bool m_isLoading;
 	Ui::HistoryContentsWidget *m_ui;
 };
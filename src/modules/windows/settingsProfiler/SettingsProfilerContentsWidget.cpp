@@ -0,0 +1,177 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "SettingsProfilerContentsWidget.h"
+#include "../../../core/ThemesManager.h"
+
+#include "ui_SettingsProfilerContentsWidget.h"
+
+#include <QtCore/QTimerEvent>
+
+namespace Otter
+{
+
+SettingsProfilerContentsWidget::SettingsProfilerContentsWidget(const QVariantMap &parameters, Window *window, QWidget *parent) : ContentsWidget(parameters, window, parent),
+	m_model(new QStandardItemModel(this)),
+	m_updateTimer(0),
+	m_ui(new Ui::SettingsProfilerContentsWidget)
+{
+	m_ui->setupUi(this);
+	m_ui->filterLineEditWidget->setClearOnEscape(true);
+	m_ui->statisticsViewWidget->setViewMode(ItemViewWidget::ListView);
+	m_ui->statisticsViewWidget->setModel(m_model);
+	m_ui->disabledLabel->setVisible(!SettingsManager::isProfilingEnabled());
+	m_ui->resetButton->setEnabled(SettingsManager::isProfilingEnabled());
+
+	m_model->setHorizontalHeaderLabels(getHeaderLabels());
+
+	populateStatistics();
+
+	if (SettingsManager::isProfilingEnabled())
+	{
+		m_updateTimer = startTimer(1000);
+	}
+
+	connect(m_ui->filterLineEditWidget, &LineEditWidget::textChanged, m_ui->statisticsViewWidget, &ItemViewWidget::setFilterString);
+	connect(m_ui->resetButton, &QPushButton::clicked, this, &SettingsProfilerContentsWidget::resetStatistics);
+}
+
+SettingsProfilerContentsWidget::~SettingsProfilerContentsWidget()
+{
+	delete m_ui;
+}
+
+void SettingsProfilerContentsWidget::timerEvent(QTimerEvent *event)
+{
+	if (event->timerId() == m_updateTimer && isVisible())
+	{
+		populateStatistics();
+	}
+
+	ContentsWidget::timerEvent(event);
+}
+
+void SettingsProfilerContentsWidget::changeEvent(QEvent *event)
+{
+	ContentsWidget::changeEvent(event);
+
+	if (event->type() == QEvent::LanguageChange)
+	{
+		m_ui->retranslateUi(this);
+
+		m_model->setHorizontalHeaderLabels(getHeaderLabels());
+	}
+}
+
+void SettingsProfilerContentsWidget::print(QPrinter *printer)
+{
+	m_ui->statisticsViewWidget->render(printer);
+}
+
+void SettingsProfilerContentsWidget::populateStatistics()
+{
+	const QVector<SettingsManager::OptionAccessStatistics> statistics(SettingsManager::getAccessStatistics());
+
+	for (int i = 0; i < statistics.count(); ++i)
+	{
+		const SettingsManager::OptionAccessStatistics &entry(statistics.at(i));
+		const QString key(QStringLiteral("%1/%2/%3").arg(entry.identifier).arg(entry.subsystem).arg(entry.isHostSpecific));
+		const QVariantList values({entry.readsAmount, (entry.readsTime / 1000), entry.writesAmount, (entry.writesTime / 1000)});
+		QStandardItem *item(m_items.value(key));
+
+		if (item)
+		{
+			for (int j = 0; j < values.count(); ++j)
+			{
+				m_model->setData(item->index().sibling(item->row(), (j + 3)), values.at(j), Qt::DisplayRole);
+			}
+
+			continue;
+		}
+
+		QList<QStandardItem*> items({new QStandardItem(SettingsManager::getOptionName(entry.identifier)), new QStandardItem(entry.isHostSpecific ? tr("Host") : tr("Global")), new QStandardItem(getSubsystemTitle(entry.subsystem))});
+
+		for (int j = 0; j < values.count(); ++j)
+		{
+			QStandardItem *valueItem(new QStandardItem());
+			valueItem->setData(values.at(j), Qt::DisplayRole);
+
+			items.append(valueItem);
+		}
+
+		for (int j = 0; j < items.count(); ++j)
+		{
+			items[j]->setFlags(items[j]->flags() | Qt::ItemNeverHasChildren);
+		}
+
+		m_items[key] = items[0];
+
+		m_model->appendRow(items);
+	}
+}
+
+void SettingsProfilerContentsWidget::resetStatistics()
+{
+	SettingsManager::resetAccessStatistics();
+
+	m_items.clear();
+	m_model->removeRows(0, m_model->rowCount());
+}
+
+QString SettingsProfilerContentsWidget::getSubsystemTitle(SettingsManager::ProfilingSubsystem subsystem) const
+{
+	switch (subsystem)
+	{
+		case SettingsManager::WebSubsystem:
+			return tr("Web");
+		case SettingsManager::NetworkSubsystem:
+			return tr("Network");
+		default:
+			break;
+	}
+
+	return tr("Other");
+}
+
+QStringList SettingsProfilerContentsWidget::getHeaderLabels() const
+{
+	return {tr("Option"), tr("Scope"), tr("Subsystem"), tr("Reads"), tr("Reads Time (µs)"), tr("Writes"), tr("Writes Time (µs)")};
+}
+
+QString SettingsProfilerContentsWidget::getTitle() const
+{
+	return tr("Settings Profiler");
+}
+
+QLatin1String SettingsProfilerContentsWidget::getType() const
+{
+	return QLatin1String("settingsProfiler");
+}
+
+QUrl SettingsProfilerContentsWidget::getUrl() const
+{
+	return QUrl(QLatin1String("about:settingsProfiler"));
+}
+
+QIcon SettingsProfilerContentsWidget::getIcon() const
+{
+	return ThemesManager::createIcon(QLatin1String("configuration"), false);
+}
+
+}
@@ -0,0 +1,71 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2020 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#ifndef OTTER_SETTINGSPROFILERCONTENTSWIDGET_H
+#define OTTER_SETTINGSPROFILERCONTENTSWIDGET_H
+
+#include "../../../core/SettingsManager.h"
+#include "../../../ui/ContentsWidget.h"
+
+#include <QtGui/QStandardItemModel>
+
+namespace Otter
+{
+
+namespace Ui
+{
+	class SettingsProfilerContentsWidget;
+}
+
+class Window;
+
+class SettingsProfilerContentsWidget final : public ContentsWidget
+{
+	Q_OBJECT
+
+public:
+	explicit SettingsProfilerContentsWidget(const QVariantMap &parameters, Window *window, QWidget *parent);
+	~SettingsProfilerContentsWidget();
+
+	void print(QPrinter *printer) override;
+	QString getTitle() const override;
+	QLatin1String getType() const override;
+	QUrl getUrl() const override;
+	QIcon getIcon() const override;
+
+protected:
+	void timerEvent(QTimerEvent *event) override;
+	void changeEvent(QEvent *event) override;
+	QString getSubsystemTitle(SettingsManager::ProfilingSubsystem subsystem) const;
+	QStringList getHeaderLabels() const;
+
+protected slots:
+	void populateStatistics();
+	void resetStatistics();
+
+private:
+	QStandardItemModel *m_model;
+	QHash<QString, QStandardItem*> m_items;
+	int m_updateTimer;
+	Ui::SettingsProfilerContentsWidget *m_ui;
+};
+
+}
+
+#endif
@@ -0,0 +1,411 @@
+/**************************************************************************
+* Otter Browser: Web browser controlled by the user, not vice-versa.
+* Copyright (C) 2026 Michal Dutkiewicz aka Emdek <michal@emdek.pl>
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program. If not, see <http://www.gnu.org/licenses/>.
+*
+**************************************************************************/
+
+#include "../core/AdblockContentFiltersProfile.h"
+#include "../core/Console.h"
+#include "../core/SessionsManager.h"
+#include "../core/Utils.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
+#include <QtCore/QTextStream>
+#include <QtCore/QThreadPool>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#include <algorithm>
+
+using namespace Otter;
+
+struct BenchmarkRequest final
+{
+	QUrl baseUrl;
+	QUrl requestUrl;
+	NetworkManager::ResourceType resourceType = NetworkManager::OtherType;
+};
+
+NetworkManager::ResourceType getResourceType(const QString &name, const QString &mimeType = {})
+{
+	const QHash<QString, NetworkManager::ResourceType> types({{QLatin1String("document"), NetworkManager::MainFrameType}, {QLatin1String("main_frame"), NetworkManager::MainFrameType}, {QLatin1String("subdocument"), NetworkManager::SubFrameType}, {QLatin1String("sub_frame"), NetworkManager::SubFrameType}, {QLatin1String("popup"), NetworkManager::PopupType}, {QLatin1String("stylesheet"), NetworkManager::StyleSheetType}, {QLatin1String("script"), NetworkManager::ScriptType}, {QLatin1String("image"), NetworkManager::ImageType}, {QLatin1String("object"), NetworkManager::ObjectType}, {QLatin1String("object-subrequest"), NetworkManager::ObjectSubrequestType}, {QLatin1String("object_subrequest"), NetworkManager::ObjectSubrequestType}, {QLatin1String("xmlhttprequest"), NetworkManager::XmlHttpRequestType}, {QLatin1String("xhr"), NetworkManager::XmlHttpRequestType}, {QLatin1String("fetch"), NetworkManager::XmlHttpRequestType}, {QLatin1String("websocket"), NetworkManager::WebSocketType}});
+	const QString normalizedName(name.trimmed().toLower());
+
+	if (types.contains(normalizedName))
+	{
+		return types.value(normalizedName);
+	}
+
+	if (mimeType.contains(QLatin1String("css")))
+	{
+		return NetworkManager::StyleSheetType;
+	}
+
+	if (mimeType.contains(QLatin1String("javascript")))
+	{
+		return NetworkManager::ScriptType;
+	}
+
+	if (mimeType.startsWith(QLatin1String("image/")))
+	{
+		return NetworkManager::ImageType;
+	}
+
+	return NetworkManager::OtherType;
+}
+
+QVector<BenchmarkRequest> loadTsvCorpus(QIODevice *device)
+{
+	QVector<BenchmarkRequest> requests;
+	QTextStream stream(device);
+	stream.setCodec("UTF-8");
+
+	while (!stream.atEnd())
+	{
+		const QString line(stream.readLine());
+
+		if (line.trimmed().isEmpty() || line.startsWith(QLatin1Char('#')))
+		{
+			continue;
+		}
+
+		const QStringList fields(line.split(QLatin1Char('\t')));
+
+		if (fields.count() < 2)
+		{
+			continue;
+		}
+
+		BenchmarkRequest request;
+		request.baseUrl = QUrl(fields.at(0));
+		request.requestUrl = QUrl(fields.at(1));
+		request.resourceType = ((fields.count() > 2) ? getResourceType(fields.at(2)) : NetworkManager::OtherType);
+
+		requests.append(request);
+	}
+
+	return requests;
+}
+
+QVector<BenchmarkRequest> loadHarCorpus(QIODevice *device)
+{
+	const QJsonObject logObject(QJsonDocument::fromJson(device->readAll()).object().value(QLatin1String("log")).toObject());
+	const QJsonArray pagesArray(logObject.value(QLatin1String("pages")).toArray());
+	const QJsonArray entriesArray(logObject.value(QLatin1String("entries")).toArray());
+	QHash<QString, QUrl> pages;
+	QVector<BenchmarkRequest> requests;
+	requests.reserve(entriesArray.count());
+
+	for (int i = 0; i < pagesArray.count(); ++i)
+	{
+		const QJsonObject pageObject(pagesArray.at(i).toObject());
+		const QUrl url(pageObject.value(QLatin1String("title")).toString());
+
+		if (url.isValid() && !url.scheme().isEmpty())
+		{
+			pages[pageObject.value(QLatin1String("id")).toString()] = url;
+		}
+	}
+
+	for (int i = 0; i < entriesArray.count(); ++i)
+	{
+		const QJsonObject entryObject(entriesArray.at(i).toObject());
+		const QString page(entryObject.value(QLatin1String("pageref")).toString());
+		BenchmarkRequest request;
+		request.requestUrl = QUrl(entryObject.value(QLatin1String("request")).toObject().value(QLatin1String("url")).toString());
+		request.resourceType = getResourceType(entryObject.value(QLatin1String("_resourceType")).toString(), entryObject.value(QLatin1String("response")).toObject().value(QLatin1String("content")).toObject().value(QLatin1String("mimeType")).toString());
+
+		if (!pages.contains(page))
+		{
+			pages[page] = request.requestUrl;
+
+			if (request.resourceType == NetworkManager::OtherType)
+			{
+				request.resourceType = NetworkManager::MainFrameType;
+			}
+		}
+
+		request.baseUrl = pages.value(page);
+
+		requests.append(request);
+	}
+
+	return requests;
+}
+
+qint64 getPercentile(QVector<qint64> values, double percentile)
+{
+	if (values.isEmpty())
+	{
+		return 0;
+	}
+
+	std::sort(values.begin(), values.end());
+
+	return values.at(qMin((values.count() - 1), static_cast<int>(values.count() * percentile)));
+}
+
+qint64 getPeakMemoryUsage()
+{
+#ifdef Q_OS_UNIX
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) == 0)
+	{
+#ifdef Q_OS_MACOS
+		return static_cast<qint64>(usage.ru_maxrss);
+#else
+		return (static_cast<qint64>(usage.ru_maxrss) * 1024);
+#endif
+	}
+#endif
+
+	return -1;
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication application(argc, argv);
+	application.setApplicationName(QLatin1String("otter-filter-bench"));
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription(QLatin1String("Replays a recorded request corpus against content blocking profiles"));
+	parser.addHelpOption();
+	parser.addPositionalArgument(QLatin1String("profiles"), QLatin1String("Directory containing Adblock filter lists (*.txt)"));
+	parser.addPositionalArgument(QLatin1String("corpus"), QLatin1String("Request corpus (TSV with base URL, request URL and resource type, or HAR)"));
+	parser.addOption(QCommandLineOption(QLatin1String("profile"), QLatin1String("Uses only profile <name>, can be repeated"), QLatin1String("name")));
+	parser.addOption(QCommandLineOption(QLatin1String("iterations"), QLatin1String("Replays the corpus <count> times"), QLatin1String("count"), QLatin1String("1")));
+	parser.addOption(QCommandLineOption(QLatin1String("verdicts"), QLatin1String("Writes verdicts to <path> instead of standard output"), QLatin1String("path")));
+	parser.addOption(QCommandLineOption(QLatin1String("no-wildcards"), QLatin1String("Disables wildcard rules")));
+	parser.process(application);
+
+	const QStringList arguments(parser.positionalArguments());
+
+	if (arguments.count() != 2)
+	{
+		parser.showHelp(1);
+	}
+
+	QTemporaryDir profilePath;
+
+	if (!profilePath.isValid() || !QDir(profilePath.path()).mkpath(QLatin1String("contentBlocking")))
+	{
+		qCritical("Failed to create temporary profile directory");
+
+		return 1;
+	}
+
+	Console::createInstance();
+	SessionsManager::createInstance(profilePath.path(), profilePath.path(), true, true);
+
+	const QStringList names(parser.values(QLatin1String("profile")));
+	const QFileInfoList lists(QDir(arguments.at(0)).entryInfoList({QLatin1String("*.txt")}, QDir::Files, QDir::Name));
+	QVector<AdblockContentFiltersProfile*> profiles;
+
+	for (int i = 0; i < lists.count(); ++i)
+	{
+		const QString name(lists.at(i).completeBaseName());
+
+		if ((!names.isEmpty() && !names.contains(name)) || !QFile::copy(lists.at(i).absoluteFilePath(), SessionsManager::getWritableDataPath(QLatin1String("contentBlocking/%1.txt")).arg(name)))
+		{
+			continue;
+		}
+
+		ContentFiltersProfile::ProfileSummary profileSummary;
+		profileSummary.name = name;
+		profileSummary.cosmeticFiltersMode = ContentFiltersManager::AllFilters;
+		profileSummary.areWildcardsEnabled = !parser.isSet(QLatin1String("no-wildcards"));
+
+		profiles.append(new AdblockContentFiltersProfile(profileSummary, {}, ContentFiltersProfile::NoFlags));
+	}
+
+	if (profiles.isEmpty())
+	{
+		qCritical("No profiles found");
+
+		return 1;
+	}
+
+	QFile corpusFile(arguments.at(1));
+
+	if (!corpusFile.open(QIODevice::ReadOnly))
+	{
+		qCritical("Failed to open corpus: %s", qPrintable(corpusFile.errorString()));
+
+		return 1;
+	}
+
+	const QVector<BenchmarkRequest> requests(arguments.at(1).endsWith(QLatin1String(".har"), Qt::CaseInsensitive) ? loadHarCorpus(&corpusFile) : loadTsvCorpus(&corpusFile));
+
+	corpusFile.close();
+
+	QElapsedTimer timer;
+	timer.start();
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		profiles.at(i)->load();
+	}
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		if (!profiles.at(i)->waitForLoaded(600000))
+		{
+			qCritical("Failed to load profile: %s", qPrintable(profiles.at(i)->getName()));
+
+			return 1;
+		}
+	}
+
+	const qint64 loadTime(timer.nsecsElapsed());
+
+	timer.restart();
+
+	if (!requests.isEmpty())
+	{
+		AdblockContentFiltersProfile::checkUrl(profiles, requests.at(0).baseUrl, requests.at(0).requestUrl, requests.at(0).resourceType);
+	}
+
+	QThreadPool::globalInstance()->waitForDone();
+
+	const qint64 indexTime(timer.nsecsElapsed());
+
+	for (int i = 0; i < requests.count(); ++i)
+	{
+		const BenchmarkRequest &request(requests.at(i));
+
+		AdblockContentFiltersProfile::checkUrl(profiles, request.baseUrl, request.requestUrl, request.resourceType);
+	}
+
+	const int iterations(qMax(1, parser.value(QLatin1String("iterations")).toInt()));
+	QVector<qint64> checkLatencies;
+	QVector<qint64> cosmeticFiltersLatencies;
+	QStringList verdicts;
+	qint64 totalTime(0);
+	checkLatencies.reserve(requests.count() * iterations);
+	verdicts.reserve(requests.count());
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		for (int j = 0; j < requests.count(); ++j)
+		{
+			const BenchmarkRequest &request(requests.at(j));
+
+			timer.restart();
+
+			const ContentFiltersManager::CheckResult result(AdblockContentFiltersProfile::checkUrl(profiles, request.baseUrl, request.requestUrl, request.resourceType));
+			const qint64 checkLatency(timer.nsecsElapsed());
+			int cosmeticFiltersAmount(-1);
+
+			checkLatencies.append(checkLatency);
+
+			totalTime += checkLatency;
+
+			if (request.resourceType == NetworkManager::MainFrameType && result.comesticFiltersMode != ContentFiltersManager::NoFilters)
+			{
+				const QStringList domains(ContentFiltersManager::createSubdomainList(request.requestUrl.host()));
+
+				cosmeticFiltersAmount = 0;
+
+				timer.restart();
+
+				for (int k = 0; k < profiles.count(); ++k)
+				{
+					cosmeticFiltersAmount += profiles.at(k)->getCosmeticFilters(domains, (result.comesticFiltersMode == ContentFiltersManager::DomainOnlyFilters)).rules.count();
+				}
+
+				const qint64 cosmeticFiltersLatency(timer.nsecsElapsed());
+
+				cosmeticFiltersLatencies.append(cosmeticFiltersLatency);
+
+				totalTime += cosmeticFiltersLatency;
+			}
+
+			if (i == 0)
+			{
+				QString verdict(QLatin1String("allow"));
+
+				if (result.isException)
+				{
+					verdict = QLatin1String("exception");
+				}
+				else if (result.isBlocked)
+				{
+					verdict = QLatin1String("block");
+				}
+
+				verdicts.append(QStringLiteral("%1\t%2\t%3\t%4\t%5\t%6").arg(QString::number(j), verdict, ((result.profile >= 0) ? profiles.at(result.profile)->getName() : QLatin1String("-")), (result.rule.isEmpty() ? QLatin1String("-") : result.rule), ((cosmeticFiltersAmount >= 0) ? QString::number(cosmeticFiltersAmount) : QLatin1String("-")), request.requestUrl.toString()));
+			}
+		}
+	}
+
+	quint64 engineMemoryUsage(0);
+
+	for (int i = 0; i < profiles.count(); ++i)
+	{
+		engineMemoryUsage += profiles.at(i)->getMemoryUsage();
+	}
+
+	const qint64 peakMemoryUsage(getPeakMemoryUsage());
+	const int checksAmount(checkLatencies.count() + cosmeticFiltersLatencies.count());
+	QTextStream output(stdout);
+	output.setFieldAlignment(QTextStream::AlignLeft);
+	output << QLatin1String("Profiles:\t") << profiles.count() << QLatin1Char('\n');
+	output << QLatin1String("Requests:\t") << requests.count() << QLatin1String(" x ") << iterations << QLatin1Char('\n');
+	output << QLatin1String("Load Time:\t") << QString::number((loadTime / 1000000.0), 'f', 2) << QLatin1String(" ms\n");
+	output << QLatin1String("Index Time:\t") << QString::number((indexTime / 1000000.0), 'f', 2) << QLatin1String(" ms\n");
+	output << QLatin1String("Check p50:\t") << QString::number((getPercentile(checkLatencies, 0.5) / 1000.0), 'f', 2) << QLatin1String(" us\n");
+	output << QLatin1String("Check p99:\t") << QString::number((getPercentile(checkLatencies, 0.99) / 1000.0), 'f', 2) << QLatin1String(" us\n");
+	output << QLatin1String("Cosmetic p50:\t") << QString::number((getPercentile(cosmeticFiltersLatencies, 0.5) / 1000.0), 'f', 2) << QLatin1String(" us\n");
+	output << QLatin1String("Cosmetic p99:\t") << QString::number((getPercentile(cosmeticFiltersLatencies, 0.99) / 1000.0), 'f', 2) << QLatin1String(" us\n");
+	output << QLatin1String("Throughput:\t") << QString::number(((totalTime > 0) ? (checksAmount / (totalTime / 1000000000.0)) : 0), 'f', 0) << QLatin1String(" checks/s\n");
+	output << QLatin1String("Engine Memory:\t") << Utils::formatUnit(static_cast<qint64>(engineMemoryUsage), false, 1, true) << QLatin1Char('\n');
+	output << QLatin1String("Peak Memory:\t") << ((peakMemoryUsage >= 0) ? Utils::formatUnit(peakMemoryUsage, false, 1, true) : QLatin1String("unknown")) << QLatin1Char('\n');
+
+	if (parser.isSet(QLatin1String("verdicts")))
+	{
+		QFile verdictsFile(parser.value(QLatin1String("verdicts")));
+
+		if (!verdictsFile.open(QIODevice::WriteOnly | QIODevice::Text))
+		{
+			qCritical("Failed to write verdicts: %s", qPrintable(verdictsFile.errorString()));
+
+			return 1;
+		}
+
+		QTextStream stream(&verdictsFile);
+		stream.setCodec("UTF-8");
+		stream << verdicts.join(QLatin1Char('\n')) << QLatin1Char('\n');
+	}
+	else
+	{
+		output << QLatin1Char('\n') << verdicts.join(QLatin1Char('\n')) << QLatin1Char('\n');
+	}
+
+	qDeleteAll(profiles);
+
+	return 0;
+}
@@ -62,6 +62,9 @@ WebWidget::WebWidget(const QVariantMap &parameters, WebBackend *backend, Content
 	Q_UNUSED(parameters)
 
 	connect(this, &WebWidget::loadingStateChanged, this, &WebWidget::handleLoadingStateChange);
+	connect(this, &WebWidget::urlChanged, this, &WebWidget::handleUrlChange);
+	connect(SettingsManager::getInstance(), &SettingsManager::optionChanged, this, &WebWidget::clearResolvedOption);
+	connect(SettingsManager::getInstance(), &SettingsManager::hostOptionChanged, this, &WebWidget::clearResolvedOption);
 	connect(BookmarksManager::getModel(), &BookmarksModel::modelModified, this, [&]()
 	{
 		emit categorizedActionsStateChanged({ActionsManager::ActionDefinition::BookmarkCategory});
@@ -262,6 +265,14 @@ void WebWidget::openUrl(const QUrl &url, SessionsManager::OpenHints hints)
 	}
 }
 
+void WebWidget::clearResolvedOption(int identifier)
+{
+	if (identifier >= 0 && identifier < m_resolvedOptions.count())
+	{
+		m_resolvedOptions[identifier] = {};
+	}
+}
+
 void WebWidget::handleLoadingStateChange(LoadingState state)
 {
 	if (m_loadingTimer != 0)
@@ -374,6 +385,17 @@ void WebWidget::handleToolTipEvent(QHelpEvent *event, QWidget *widget)
 	}
 }
 
+void WebWidget::handleUrlChange()
+{
+	const QString host(Utils::extractHost(getUrl()));
+
+	if (host != m_resolvedOptionsHost)
+	{
+		m_resolvedOptionsHost = host;
+		m_resolvedOptions = QVector<QVariant>(m_resolvedOptions.count());
+	}
+}
+
 void WebWidget::handleWindowCloseRequest()
 {
 	const QString host(Utils::extractHost(getUrl()));
@@ -974,7 +996,36 @@ QVariant WebWidget::getOption(int identifier, const QUrl &url) const
 		return m_options[identifier];
 	}
 
-	return SettingsManager::getOption(identifier, Utils::extractHost(url.isEmpty() ? getUrl() : url));
+	if (identifier < 0)
+	{
+		return {};
+	}
+
+	const SettingsManager::ProfilingScope profilingScope(SettingsManager::WebSubsystem);
+
+	if (!url.isEmpty())
+	{
+		const QString host(Utils::extractHost(url));
+
+		if (host != m_resolvedOptionsHost)
+		{
+			return SettingsManager::getOption(identifier, host);
+		}
+	}
+
+	if (identifier >= m_resolvedOptions.count())
+	{
+		m_resolvedOptions.resize(identifier + 1);
+	}
+
+	QVariant &value(m_resolvedOptions[identifier]);
+
+	if (!value.isValid())
+	{
+		value = SettingsManager::getOption(identifier, m_resolvedOptionsHost);
+	}
+
+	return value;
 }
 
 QVariant WebWidget::getPageInformation(PageInformation key) const
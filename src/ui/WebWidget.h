@@ -312,7 +312,9 @@ protected:
 	virtual bool isScrollBar(const QPoint &position) const;
 
 protected slots:
+	void clearResolvedOption(int identifier);
 	void handleLoadingStateChange(LoadingState state);
+	void handleUrlChange();
 	void handleWindowCloseRequest();
 	void notifyRedoActionStateChanged();
 	void notifyUndoActionStateChanged();
@@ -325,8 +327,10 @@ private:
 	QUrl m_requestedUrl;
 	QString m_statusMessage;
 	QString m_statusMessageOverride;
+	QString m_resolvedOptionsHost;
 	QPoint m_clickPosition;
 	QHash<int, QVariant> m_options;
+	mutable QVector<QVariant> m_resolvedOptions;
 	QHash<ChangeWatcher, QVector<QObject*> > m_changeWatchers;
 	HitTestResult m_hitResult;
 	quint64 m_windowIdentifier;
@@ -51,6 +51,7 @@
 #include "../modules/windows/pageInformation/PageInformationContentsWidget.h"
 #include "../modules/windows/passwords/PasswordsContentsWidget.h"
 #include "../modules/windows/preferences/PreferencesContentsWidget.h"
+#include "../modules/windows/settingsProfiler/SettingsProfilerContentsWidget.h"
 #include "../modules/windows/tabHistory/TabHistoryContentsWidget.h"
 #include "../modules/windows/transfers/TransfersContentsWidget.h"
 #include "../modules/windows/web/WebContentsWidget.h"
@@ -265,6 +266,11 @@ ContentsWidget* createContentsWidget(const QString &identifier, const QVariantMa
 		return new PreferencesContentsWidget(parameters, window, parent);
 	}
 
+	if (identifier == QLatin1String("settingsProfiler"))
+	{
+		return new SettingsProfilerContentsWidget(parameters, window, parent);
+	}
+
 	if (identifier == QLatin1String("transfers"))
 	{
 		return new TransfersContentsWidget(parameters, window, parent);